@@ -0,0 +1,116 @@
+#include <iostream>
+using namespace std;
+
+#include <chrono>
+#include <cstdlib>
+#include <string>
+
+#include "board.h"
+#include "boardtree.h"
+#include "hashtable.h"
+#include "mcts.h"
+#include "proofsearch.h"
+
+// Benchmark positions, given as the cells (row * 4 + col) played from the empty board, X first. They cover the opening,
+// quiet middle games and positions with open threats, and double as the training workload of "make pgo".
+// Moves that do not fit the current BOARD_SIZE are skipped.
+static const char* const BENCH_POSITIONS[] = {
+    "",
+    "5",
+    "5 10",
+    "0 15 5",
+    "5 6 10 9",
+    "0 1 5 2 10",
+    "3 6 9 12 0",
+    "5 10 6 9 4 7",
+    "0 3 12 15 5 6 9",
+    "1 2 4 8 7 11 13 14",
+    "5 0 10 15 6 9 3 12 1",
+    "0 5 1 6 2 9 8 10 4 13",
+};
+
+// Build the board of one benchmark position
+static Board makePosition(const char* moves)
+{
+    Board board{SCORE_PRESET};
+    char* next = const_cast<char*>(moves);
+    while (*next != '\0') {
+        char* start = next;
+        const long cell = strtol(start, &next, 10);
+        if (next == start) break;
+        if (cell / 4 < BOARD_SIZE && cell % 4 < BOARD_SIZE) {
+            board.play(BoardCoordinate(cell / 4, cell % 4));
+        }
+    }
+    return board;
+}
+
+int main(int argc, char* argv[]) {
+    int searchDepth = 6;
+    unsigned int iterations = 20000;
+    for (int i=1; i<argc; i++) {
+        if ((string(argv[i]) == "-d" || string(argv[i]) == "--depth") && i < argc - 1) {
+            searchDepth = atoi(argv[++i]);
+        }
+        else if ((string(argv[i]) == "-i" || string(argv[i]) == "--iterations") && i < argc - 1) {
+            iterations = atoi(argv[++i]);
+        }
+        else {
+            cout << "Usage: pa3_bench.exe [-d depth] [-i mcts_iterations]" << endl;
+            return 0;
+        }
+    }
+
+    const char* const engines[] = {"minimax", "alphabeta", "aspiration", "prove", "mcts"};
+    unsigned long long totalNodes[5] = {0};
+    long long totalMs[5] = {0};
+
+    for (const char* moves : BENCH_POSITIONS) {
+        const Board board = makePosition(moves);
+        if (board.isFinished()) continue;
+        cout << "Position [" << moves << "]" << endl;
+
+        for (int e = 0; e < 5; ++e) {
+            // Every engine starts from an empty table and tree so that the runs do not depend on each other
+            BoardHashTable::getInstance().clearTable();
+            SearchStats& stats = SearchStats::getInstance();
+            stats.reset();
+
+            chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+            BoardOptimalMove optMove;
+            unsigned long long nodes = 0;
+            if (e < 3) {
+                BoardTree tree{board};
+                if (e == 0) optMove = tree.getOptimalMove(searchDepth);
+                else if (e == 1) optMove = tree.getOptimalMoveAlphaBeta(searchDepth, -WIN_SCORE - 1, WIN_SCORE + 1);
+                else optMove = tree.getOptimalMoveAspiration(searchDepth, 0);
+                nodes = stats.nodes;
+            }
+            else if (e == 3) {
+                ProofNumberSearch prover;
+                ProofOutcome outcome = prover.prove(board, board.getCurPlayer());
+                optMove = BoardOptimalMove(outcome.score, outcome.move);
+                nodes = outcome.nodes;
+            }
+            else {
+                MCTSLimits limits;
+                limits.iterations = iterations;
+                MCTSEngine engine{limits};
+                optMove = engine.getOptimalMove(board);
+                nodes = engine.getIterations();
+            }
+            long long ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - begin).count();
+
+            cout << "  " << engines[e] << ": score " << optMove.score << ", move (" << optMove.coords.row << ", " << optMove.coords.col
+                 << "), nodes " << nodes << ", " << ms << " ms" << endl;
+            totalNodes[e] += nodes;
+            totalMs[e] += ms;
+        }
+    }
+
+    cout << "Total:" << endl;
+    for (int e = 0; e < 5; ++e) {
+        cout << "  " << engines[e] << ": nodes " << totalNodes[e] << ", " << totalMs[e] << " ms" << endl;
+    }
+    return 0;
+}
\ No newline at end of file
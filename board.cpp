@@ -1,5 +1,8 @@
+#include <algorithm>
 #include "board.h"
 #include "const.h"
+#include "tables.h"
+#include "profiler.h"
 
 // Implement the Board class here
 
@@ -7,27 +10,33 @@
 // All data members are non-dynamic, so default memberwise copy constructor and assignment operator are enough.
 Board::Board(const int score[][BOARD_SIZE])
 {
+    // The fingerprint is a 64-bit FNV-1a style hash of the score grid, finished with a multiply-xorshift so that grids
+    // differing in a single cell get unrelated fingerprints.
+    gridFingerprint = 0xCBF29CE484222325ULL;
     for (int i = 0; i < BOARD_SIZE; ++i) {
         for (int j = 0; j < BOARD_SIZE; j++) {
             cells[i][j] = EMPTY;
             this->score[i][j] = score[i][j];
+            gridFingerprint = (gridFingerprint ^ static_cast<unsigned int>(score[i][j])) * 0x100000001B3ULL;
         }
     }
+    gridFingerprint ^= gridFingerprint >> 29;
+    gridFingerprint *= 0xBF58476D1CE4E5B9ULL;
+    gridFingerprint ^= gridFingerprint >> 32;
     curPlayer = X;
     id = 0;
+    material = 0;
+    winner = EMPTY;
+    moveCount = 0;
+    for (int l = 0; l < LINE_COUNT; ++l) {
+        lineCount[l][0] = lineCount[l][1] = 0;
+    }
 }
 
 // bool isFull() const: Returns true if all cells are non-empty.
 bool Board::isFull() const
 {
-    for (int i = 0; i < BOARD_SIZE; ++i) {
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            if (cells[i][j] == EMPTY) {
-                return false;
-            }
-        }
-    }
-    return true;
+    return moveCount == CELL_COUNT;
 }
 
 // bool isFinished() const: Returns true if the game has finished (a match is found (therefore score is WIN_SCORE or -WIN_SCORE) or board is full
@@ -38,86 +47,95 @@ bool Board::isFinished() const
 
 // int getBoardScore() const: Checks if a player has a match, if so, returns WIN_SCORE or -WIN_SCORE.
 // Otherwise, returns the sum of X's score minus O's score, scaled by getCellWeight.
-
+// Both are kept up to date by play(), so this is only a lookup.
 int Board::getBoardScore() const
 {
-    // Check if all of a row, column, or diagonal is the same.
+    if (winner != EMPTY) {
+        return winner * WIN_SCORE;
+    }
+    return material;
+}
 
-    // Check for if the sum of a row is board size * X or board size * O
-    for (int i = 0; i < BOARD_SIZE; ++i) {
-        int rowSum = 0;
-        int colSum = 0;
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            if (cells[i][j] != EMPTY) {
-                rowSum += cells[i][j];
-            }
-            if (cells[j][i] != EMPTY) {
-                colSum += cells[j][i];
-            }
-        }
-        if (rowSum == BOARD_SIZE * X || colSum == BOARD_SIZE * X) {
-            // std::cout << "rowSum" << std::endl;
-            return WIN_SCORE;
+// int getThreatCells(const Cell player, MoveList& moves) const: Finds the lines with WIN_LENGTH - 1 cells of player and
+// none of the opponent from the line counts, and adds their empty cell to moves (once, even if it completes several lines).
+int Board::getThreatCells(const Cell player, MoveList& moves) const
+{
+    moves.clear();
+    const int own = (player == X) ? 0 : 1;
+    for (int l = 0; l < LINE_COUNT; ++l) {
+        if (lineCount[l][own] != WIN_LENGTH - 1 || lineCount[l][1 - own] != 0) {
+            continue;
         }
-        if (rowSum == BOARD_SIZE * O || colSum == BOARD_SIZE * O) {
-            // std::cout << "rowSumo" << std::endl;
-            return -WIN_SCORE;
+        for (int k = 0; k < WIN_LENGTH; ++k) {
+            const int cell = WIN_LINES.cells[l][k];
+            const BoardCoordinate coords(cell / BOARD_SIZE, cell % BOARD_SIZE);
+            if (cells[coords.row][coords.col] == EMPTY) {
+                if (!moves.contains(coords)) {
+                    moves.add(coords);
+                }
+                break;
+            }
         }
     }
+    return moves.count;
+}
 
-    // Check for if the sum of a column is board size * X or board size * O
-    // for (int i = 0; i < BOARD_SIZE; ++i) {
-    //         int colSum = 0;
-    //         for (int j = 0; j < BOARD_SIZE; j++) {
-    //             if (cells[j][i] != EMPTY) {
-    //                 colSum += cells[j][i];
-    //             }
-    //         }
-    //         if (colSum == BOARD_SIZE * X) {
-    //             // std::cout << "colSum" << std::endl;
-    //             return WIN_SCORE;
-    //         }
-    //         if (colSum == BOARD_SIZE * O) {
-    //             // std::cout << "colSumo" << std::endl;
-    //             return -WIN_SCORE;
-    //         }
-    //     }
-
-    // Check for if the sum of a diagonal is board size * X or board size * O
-    int diagSum1 = 0;
-    int diagSum2 = 0;
+// int getLegalMoves(MoveList& moves) const: Lists the moves play() would accept, so that searches do not have to try
+// (and copy the board for) every cell.
+int Board::getLegalMoves(MoveList& moves) const
+{
+    moves.clear();
+    if (isFinished()) {
+        return 0;
+    }
     for (int i = 0; i < BOARD_SIZE; ++i) {
-        if (cells[i][i] != EMPTY) {
-            diagSum1 += cells[i][i];
-        }
-        if (cells[i][BOARD_SIZE - i - 1] != EMPTY) {
-            diagSum2 += cells[i][BOARD_SIZE - i - 1];
+        for (int j = 0; j < BOARD_SIZE; ++j) {
+            if (cells[i][j] == EMPTY) {
+                moves.cells[moves.count++] = i * BOARD_SIZE + j;
+            }
         }
     }
-    if (diagSum1 == BOARD_SIZE * X || diagSum2 == BOARD_SIZE * X) {
-        // std::cout << "diagSum1" << std::endl;
-        return WIN_SCORE;
+    return moves.count;
+}
+
+// int getCandidateMoves(MoveList& moves, const int radius) const: On large boards, moves far away from all stones are
+// almost never good, so searches can leave them out. Every stone marks the cells around it, and the marked empty cells
+// are listed in row-major order.
+int Board::getCandidateMoves(MoveList& moves, const int radius) const
+{
+    if (radius <= 0 || moveCount == 0) {
+        getLegalMoves(moves);
+        if (radius > 0 && moves.count > 0) {
+            moves.clear();
+            moves.add(BoardCoordinate(BOARD_SIZE / 2, BOARD_SIZE / 2));
+        }
+        return moves.count;
     }
-    if (diagSum1 == BOARD_SIZE * O || diagSum2 == BOARD_SIZE * O) {
-        // std::cout << "diagSum1o" << std::endl;
-        return -WIN_SCORE;
+    moves.clear();
+    if (isFinished()) {
+        return 0;
     }
-
-    // If there is no match, return the sum of X's score minus O's score, scaled by getCellWeight.
-    int xSum = 0;
-    int oSum = 0;
+    bool near[BOARD_SIZE][BOARD_SIZE] {};
     for (int i = 0; i < BOARD_SIZE; ++i) {
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            if (cells[i][j] == X) {
-                xSum += score[i][j];
+        for (int j = 0; j < BOARD_SIZE; ++j) {
+            if (cells[i][j] == EMPTY) {
+                continue;
+            }
+            for (int r = std::max(i - radius, 0); r <= std::min(i + radius, BOARD_SIZE - 1); ++r) {
+                for (int c = std::max(j - radius, 0); c <= std::min(j + radius, BOARD_SIZE - 1); ++c) {
+                    near[r][c] = true;
+                }
             }
-            if (cells[i][j] == O) {
-                oSum += score[i][j];
+        }
+    }
+    for (int i = 0; i < BOARD_SIZE; ++i) {
+        for (int j = 0; j < BOARD_SIZE; ++j) {
+            if (near[i][j] && cells[i][j] == EMPTY) {
+                moves.cells[moves.count++] = i * BOARD_SIZE + j;
             }
         }
     }
-    // std::cout << "no match" << std::endl;
-    return xSum * getCellWeight(Cell::X) - oSum * getCellWeight(Cell::O);
+    return moves.count;
 }
 
 // bool play(const BoardCoordinate& coords) : Plays at the given coordinates if the cell is empty and in bounds
@@ -131,6 +149,7 @@ int Board::getBoardScore() const
 // }
 bool Board::play(const BoardCoordinate& coords)
 {
+    PROFILE_SCOPE(PROFILE_PLAY);
     if (coords.row < 0 || coords.row >= BOARD_SIZE || coords.col < 0 || coords.col >= BOARD_SIZE) {
         return false;
     }
@@ -138,14 +157,38 @@ bool Board::play(const BoardCoordinate& coords)
         return false;
     }
     cells[coords.row][coords.col] = curPlayer;
-    curPlayer = (curPlayer == X) ? O : X;
-    id = 0;
-    for (int i = 0; i < BOARD_SIZE; ++i) {
-        int cellValue = 0;
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            cellValue = (cells[i][j] == X) ? 1 : ((cells[i][j] == O) ? 2 : 0);
-            id += cellValue * (int)pow(3, i * BOARD_SIZE + j);
+    const int cell = coords.row * BOARD_SIZE + coords.col;
+
+    // Only the lines through the new cell can have been completed by this move
+    const int player = (curPlayer == X) ? 0 : 1;
+    for (int k = 0; k < CELL_LINES.count[cell]; ++k) {
+        const int line = CELL_LINES.lines[cell][k];
+        if (++lineCount[line][player] == WIN_LENGTH && winner == EMPTY) {
+            winner = curPlayer;
         }
     }
+
+    // Every cell contributes its key to the id (cellValue * 3 ^ cell on small boards), so only the new cell has to be added
+    material += curPlayer * getCellWeight(curPlayer) * score[coords.row][coords.col];
+    id += CELL_KEYS.value[cell][player];
+    ++moveCount;
+    curPlayer = (curPlayer == X) ? O : X;
     return true;
 }
+
+// void undo(const BoardCoordinate& coords) : Reverts every change play() made for the move at coords.
+// No match existed before that move, so the winner is reset to EMPTY.
+void Board::undo(const BoardCoordinate& coords)
+{
+    curPlayer = (curPlayer == X) ? O : X;
+    const int cell = coords.row * BOARD_SIZE + coords.col;
+    const int player = (curPlayer == X) ? 0 : 1;
+    for (int k = 0; k < CELL_LINES.count[cell]; ++k) {
+        --lineCount[CELL_LINES.lines[cell][k]][player];
+    }
+    winner = EMPTY;
+    material -= curPlayer * getCellWeight(curPlayer) * score[coords.row][coords.col];
+    id -= CELL_KEYS.value[cell][player];
+    --moveCount;
+    cells[coords.row][coords.col] = EMPTY;
+}
\ No newline at end of file
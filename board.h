@@ -3,6 +3,7 @@
 
 #include <iostream>
 #include "const.h"
+#include "tables.h"
 
 struct BoardCoordinate {
     int row, col;
@@ -20,6 +21,23 @@ struct BoardOptimalMove {
     BoardOptimalMove(const int score, const BoardCoordinate& coords): score(score), coords(coords) {}
 };
 
+// A list of moves, stored as cell indices (row * BOARD_SIZE + col) so that it stays small.
+struct MoveList {
+    int cells[BOARD_SIZE * BOARD_SIZE];
+    int count {0};
+
+    void clear() { count = 0; }
+    void add(const BoardCoordinate& coords) { cells[count++] = coords.row * BOARD_SIZE + coords.col; }
+    bool contains(const BoardCoordinate& coords) const
+    {
+        for (int k = 0; k < count; ++k) {
+            if (cells[k] == coords.row * BOARD_SIZE + coords.col) return true;
+        }
+        return false;
+    }
+    BoardCoordinate operator[](const int index) const { return BoardCoordinate(cells[index] / BOARD_SIZE, cells[index] % BOARD_SIZE); }
+};
+
 class Board {
     friend std::ostream& operator<<(std::ostream& os, const Board& board) {
         printBoard<const Cell, const char>(os, board.cells, cell2chr);
@@ -31,6 +49,11 @@ class Board {
         int score[BOARD_SIZE][BOARD_SIZE];
         Cell curPlayer;
         unsigned long long id;
+        unsigned long long gridFingerprint; // Hash of the score grid, see getHashKey()
+        int material;   // X's score minus O's score, already scaled by getCellWeight. Updated by play().
+        Cell winner;    // Player who completed a match, or EMPTY. Updated by play().
+        int moveCount;  // Number of non-empty cells
+        unsigned char lineCount[LINE_COUNT][2]; // Cells of X (index 0) and O (index 1) on each line. Updated by play().
 
     public:
         // Initialize cells as all empty, score with the given parameter, curPlayer as X and id as 0.
@@ -45,12 +68,41 @@ class Board {
         // Calculate the board's current score.
         int getBoardScore() const;
 
+        // Fill moves with the empty cells that would complete a match for player, i.e. the last empty cell of a line of
+        // WIN_LENGTH cells whose other cells all belong to player. Return the number of such cells.
+        int getThreatCells(const Cell player, MoveList& moves) const;
+
+        // Fill moves with the empty cells in row-major order, or nothing if the game has finished. Return the number of moves.
+        int getLegalMoves(MoveList& moves) const;
+
+        // Like getLegalMoves(), but only the empty cells within radius rows and columns of a non-empty cell, or the center
+        // cell on an empty board. A radius of 0 returns all legal moves. Return the number of moves.
+        int getCandidateMoves(MoveList& moves, const int radius) const;
+
         // Play the next move at coords. If successful, update the data members and return true. Otherwise return false.
         bool play(const BoardCoordinate& coords);
 
+        // Take back the last move, which play() made at coords. The board must not have been finished before that move.
+        void undo(const BoardCoordinate& coords);
+
         // Implemented
         Cell getCurPlayer() const { return curPlayer; }
+        Cell getCell(const BoardCoordinate& coords) const { return cells[coords.row][coords.col]; }
         unsigned long long getID() const { return id; }
+        int getMoveCount() const { return moveCount; }
+        int getCellScore(const BoardCoordinate& coords) const { return score[coords.row][coords.col]; }
+
+        // Transposition table key. Scores depend on the score grid, so the same cells under different grids must not share
+        // an entry. The key mixes the ID with a fingerprint of the grid to keep them apart.
+        unsigned long long getHashKey() const { return id ^ gridFingerprint; }
+
+        // ID and transposition table key of the board after the current player plays at the empty cell coords, without
+        // playing the move. Lets a search prefetch the table entries of a child before it creates the child.
+        unsigned long long getChildID(const BoardCoordinate& coords) const
+        {
+            return id + CELL_KEYS.value[coords.row * BOARD_SIZE + coords.col][curPlayer == X ? 0 : 1];
+        }
+        unsigned long long getChildHashKey(const BoardCoordinate& coords) const { return getChildID(coords) ^ gridFingerprint; }
 };
 
 #endif // __BOARD_H__
\ No newline at end of file
@@ -2,20 +2,297 @@
 //   This class represents the search tree of the minimax algorithm. Its structure is similar to the BT and BST examples given in the course materials: the class contains a single data member which is a pointer to a struct BoardNode. This struct contains a const Board instance and a 2D array of BoardTree representing the subtrees of the current node. A leaf node is an empty node (root == nullptr), which can either mean the node has not been explored, or the board/move represented by that node is illegal.
 
 // Example: Consider a BoardTree representing a 3x3 board with an X played in the middle. This means root->board is the board configuration, and root->subtree is a 3x3 array of BoardTree representing the 9 possible moves of O. If the next step has not been explored, all 9 array elements are default initialized and will be empty leaf nodes. Once we explore this node fully, all array elements will be non-empty, except root->subtree[1][1], since O cannot make a move in the middle cell occupied by X.
+#include <algorithm>
+#include <vector>
 #include "boardtree.h"
 #include "const.h"
+#include "profiler.h"
+
+// BoardTreeBudget::touch
+//  The list is doubly linked, so moving a node only rewires its neighbours.
+void BoardTreeBudget::touch(BoardNode* node)
+{
+    if (newest == node) {
+        return;
+    }
+    unlink(node);
+    link(node);
+}
+
+// BoardTreeBudget::link
+void BoardTreeBudget::link(BoardNode* node)
+{
+    node->older = newest;
+    node->newer = nullptr;
+    if (newest) {
+        newest->newer = node;
+    } else {
+        oldest = node;
+    }
+    newest = node;
+    nodeCount++;
+}
+
+// BoardTreeBudget::unlink
+void BoardTreeBudget::unlink(BoardNode* node)
+{
+    if (node->older) {
+        node->older->newer = node->newer;
+    } else {
+        oldest = node->newer;
+    }
+    if (node->newer) {
+        node->newer->older = node->older;
+    } else {
+        newest = node->older;
+    }
+    node->older = node->newer = nullptr;
+    nodeCount--;
+}
+
+// BoardNode constructor
+//  Every node registers itself with the budget of its tree
+BoardNode::BoardNode(const Board& board, BoardNode* parent, BoardTree* owner, BoardTreeBudget* budget):
+    board(board), parent(parent), owner(owner), budget(budget)
+{
+    budget->link(this);
+}
+
+// BoardNode destructor
+//  The sub-trees are destroyed after this, and unregister themselves the same way. BoardTree::destroy() empties them
+//  first, so this never recurses in practice.
+BoardNode::~BoardNode()
+{
+    if (budget) {
+        budget->unlink(this);
+    }
+}
+
+// BoardNodePin
+//  Pins a node for the lifetime of the object and marks it as the most recently used node. The ancestors of a pinned
+//  node are pinned too, since collapsing any of them would delete the node. Within a search the parent is always pinned
+//  already, so only the node itself is updated. Only the first node of a search walks up to the top of the tree.
+class BoardNodePin {
+    private:
+        BoardNode* node;
+        BoardNode* last; // Highest node pinned by this object
+
+    public:
+        BoardNodePin(BoardNode* node): node(node), last(node)
+        {
+            node->budget->touch(node);
+            for (BoardNode* current = node; current != nullptr; current = current->parent) {
+                last = current;
+                if (current->pins++ > 0) {
+                    break;
+                }
+            }
+        }
+        ~BoardNodePin()
+        {
+            for (BoardNode* current = node; ; current = current->parent) {
+                current->pins--;
+                if (current == last) {
+                    break;
+                }
+            }
+        }
+        BoardNodePin(const BoardNodePin&) = delete;
+        BoardNodePin& operator=(const BoardNodePin&) = delete;
+};
+
+// isExactWinDistance
+//  A match within the searched depth is the fastest one, as long as every move was searched to the full depth. Wins
+//  beyond it come from the threat extension (or from bounds), which only tries forcing moves.
+static bool isExactWinDistance(const int score, const unsigned int depth)
+{
+    return getWinDistance(score) <= static_cast<int>(depth) && !SearchOptions::getInstance().isSelective();
+}
+
+// storeWin
+//  The forced win table is shared by every search, whatever its options, so only full-width searches store their wins.
+//  A selective search did not try every defence, so its wins are no proofs.
+static void storeWin(BoardHashTable& hashTable, const Board& board, const BoardOptimalMove& bestMove, const unsigned int depth)
+{
+    if (isWinScore(bestMove.score) && !SearchOptions::getInstance().isSelective()) {
+        hashTable.storeForcedWin(board.getID(), bestMove, isExactWinDistance(bestMove.score, depth));
+    }
+}
+
+// getTableKey
+//  Transposition table key of board for the options of the current search, see SearchOptions::getTableSalt()
+static unsigned long long getTableKey(const Board& board)
+{
+    return board.getHashKey() ^ SearchOptions::getInstance().getTableSalt();
+}
 
 // BoardTree constructor
-// Initialize root using the provided board
+// Initialize root using the provided board. The new node is the top of a tree, so it also gets the budget of the tree.
 BoardTree::BoardTree(const Board& board)
 {
-    root = new BoardNode(board);
+    root = new BoardNode(board, nullptr, this, new BoardTreeBudget);
 }
 
 // BoardTree destructor
+// Deleting root directly would recurse once per level through the sub-tree arrays, so the tree is deleted iteratively
 BoardTree::~BoardTree()
 {
-    delete root;
+    if (root != nullptr) {
+        destroy(root);
+    }
+}
+
+// BoardTree::destroy
+//  Nodes are taken from an explicit stack. The sub-trees of a node are moved to the stack and emptied before the node is
+//  deleted, so its destructor has nothing left to delete. If node is the top of its tree, the budget dies with the
+//  tree: the nodes skip unregistering from it one by one, and it is deleted at the end.
+void BoardTree::destroy(BoardNode* node)
+{
+    BoardTreeBudget* ownedBudget = (node->parent == nullptr) ? node->budget : nullptr;
+    std::vector<BoardNode*> stack {node};
+    while (!stack.empty()) {
+        BoardNode* current = stack.back();
+        stack.pop_back();
+        for (int i = 0; i < BOARD_SIZE; ++i) {
+            for (int j = 0; j < BOARD_SIZE; ++j) {
+                BoardTree& subTree = current->subTree[i][j];
+                if (subTree.root != nullptr) {
+                    stack.push_back(subTree.root);
+                    subTree.root = nullptr;
+                }
+            }
+        }
+        if (ownedBudget) {
+            current->budget = nullptr;
+        }
+        delete current;
+    }
+    delete ownedBudget;
+}
+
+// BoardTree::detach
+//  Needed before a subtree is deleted on another thread, since the rest of its tree keeps using the budget. This only
+//  rewires the list, which is much cheaper than freeing the nodes.
+void BoardTree::detach(BoardNode* node)
+{
+    std::vector<BoardNode*> stack {node};
+    while (!stack.empty()) {
+        BoardNode* current = stack.back();
+        stack.pop_back();
+        for (int i = 0; i < BOARD_SIZE; ++i) {
+            for (int j = 0; j < BOARD_SIZE; ++j) {
+                if (current->subTree[i][j].root != nullptr) {
+                    stack.push_back(current->subTree[i][j].root);
+                }
+            }
+        }
+        if (current->budget) {
+            current->budget->unlink(current);
+            current->budget = nullptr;
+        }
+    }
+    node->parent = nullptr;
+    node->owner = nullptr;
+}
+
+// BoardTree::clear
+//  A whole tree takes its budget along, so it can be handed over as it is. A subtree has to leave the budget of its
+//  tree first.
+void BoardTree::clear(const bool background)
+{
+    if (root == nullptr) {
+        return;
+    }
+    BoardNode* node = root;
+    root = nullptr;
+    if (!background) {
+        destroy(node);
+        return;
+    }
+    if (node->parent != nullptr) {
+        detach(node);
+    }
+    BoardTreeReclaimer::getInstance().reclaim(node);
+}
+
+// BoardTree::clearSubTrees
+void BoardTree::clearSubTrees(const BoardCoordinate& keep, const bool background)
+{
+    if (root == nullptr) {
+        return;
+    }
+    for (int i = 0; i < BOARD_SIZE; ++i) {
+        for (int j = 0; j < BOARD_SIZE; ++j) {
+            if (i != keep.row || j != keep.col) {
+                root->subTree[i][j].clear(background);
+            }
+        }
+    }
+}
+
+// BoardTreeReclaimer destructor
+//  Runs at exit. Every queued tree is deleted before the worker stops.
+BoardTreeReclaimer::~BoardTreeReclaimer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    queueChanged.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+// BoardTreeReclaimer::reclaim
+void BoardTreeReclaimer::reclaim(BoardNode* node)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!worker.joinable()) {
+            worker = std::thread(&BoardTreeReclaimer::workerLoop, this);
+        }
+        queue.push_back(node);
+    }
+    queueChanged.notify_all();
+}
+
+// BoardTreeReclaimer::workerLoop
+//  Trees are deleted outside of the lock, so reclaim() never waits for a deletion.
+void BoardTreeReclaimer::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        queueChanged.wait(lock, [this]() { return !queue.empty() || stopping; });
+        if (queue.empty()) {
+            return;
+        }
+        BoardNode* node = queue.back();
+        queue.pop_back();
+        lock.unlock();
+        BoardTree::destroy(node);
+        lock.lock();
+    }
+}
+
+// BoardTree::evict
+//  Walk the list from the least recently used end and collapse every unpinned node found. Collapsing a node deletes its
+//  whole subtree, which removes those nodes from the list as well, so the walk restarts from the oldest end afterwards.
+//  The pinned nodes are the current search path and its ancestors, so there are only a few of them to skip.
+void BoardTree::evict(BoardTreeBudget& budget, const unsigned long long maxNodes, const BoardNode* keep)
+{
+    while (budget.nodeCount > maxNodes) {
+        BoardNode* victim = budget.oldest;
+        while (victim != nullptr && (victim->pins > 0 || victim == keep)) {
+            victim = victim->newer;
+        }
+        if (victim == nullptr) {
+            return;
+        }
+        victim->owner->root = nullptr;
+        destroy(victim);
+        SearchStats::getInstance().evictions++;
+    }
 }
 
 // BoardTree::getSubTree
@@ -25,31 +302,35 @@ BoardTree::~BoardTree()
 BoardTree* BoardTree::getSubTree(const BoardCoordinate& coords)
 {
     // If the tree is empty, return nullptr
-    if (isEmpty()) {
+    if (isEmpty() || !coords.isValid()) {
         return nullptr;
     }
 
-    // Get the board at the root of the tree
+    // Get the sub-tree at the given coordinates
+    // UPDATED: A sub-tree that is already built is returned right away, without copying the board
+    BoardTree* subTree = &root->subTree[coords.row][coords.col];
+    if (!subTree->isEmpty()) {
+        return subTree;
+    }
 
     // Get the board at the root of the tree
+    PROFILE_SCOPE(PROFILE_ALLOC);
     Board board = root->board;
 
-    // Get the sub-tree at the given coordinates
-    BoardTree* subTree = &root->subTree[coords.row][coords.col];
-
     // If the move is invalid, still return a pointer to the subtree but do not build it
     if (!board.play(coords)) {
-        subTree->root = nullptr;
         return subTree;
     }
 
-    // If the sub-tree is empty, initialize it
-    if (subTree->isEmpty()) {
-        subTree->root = new BoardNode(board);
+    // Initialize the sub-tree with the board after the move
+    // ADDED: Enforce the memory cap, but only during a search (while this node is pinned). Outside of a search, the
+    // caller may be holding pointers anywhere in the tree.
+    subTree->root = new BoardNode(board, root, subTree, root->budget);
+    const unsigned int treeMB = SearchOptions::getInstance().treeMB;
+    if (treeMB > 0 && root->pins > 0) {
+        evict(*root->budget, treeMB * 1024ULL * 1024ULL / sizeof(BoardNode), subTree->root);
     }
 
-    // Play the move on the board
-
     // Return a pointer to the sub-tree
     return subTree;
 }
@@ -99,7 +380,7 @@ BoardTree* BoardTree::getSubTree(const BoardCoordinate& coords)
 BoardOptimalMove BoardTree::getOptimalMove(const unsigned int depth)
 {
     // Get instance of hashtable
-    BoardHashTable& hashTable = BoardHashTable::getInstance();
+    BoardHashTable& hashTable = SearchOptions::getInstance().getHashTable();
 
     //  if (tree is empty) {
     //   return BoardOptimalMove(); // Returns a dummy illegal move
@@ -108,6 +389,8 @@ BoardOptimalMove BoardTree::getOptimalMove(const unsigned int depth)
     if (root == nullptr) {
         return BoardOptimalMove();
     }
+    SearchStats::getInstance().nodes++;
+    BoardNodePin pin(root);
 
     // if (depth == 0 || board is finished) {
     // If depth is 0 or if the game has already finished, we cannot search further
@@ -115,17 +398,39 @@ BoardOptimalMove BoardTree::getOptimalMove(const unsigned int depth)
     // return BoardOptimalMove(board score, any coordinates);
     // }
     if (depth == 0 || root->board.isFinished()) {
+        // ADDED: A static score is misleading if a match can be completed next move, so search the forcing moves further
+        if (depth == 0 && SearchOptions::getInstance().threatExtension && !root->board.isFinished()) {
+            return getThreatExtension(SearchOptions::getInstance().maxExtension);
+        }
+        PROFILE_SCOPE(PROFILE_EVAL);
         return BoardOptimalMove(root->board.getBoardScore(), BoardCoordinate(0, 0));
     }
 
     // ADDED: Implement hashtable feature to speed up function
     // if (board and depth are in hashtable) {
     // return the optimal move stored in the hashtable }
-    BoardOptimalMove hashedMove = hashTable.getHashedMove(root->board.getID(), depth);
+    // UPDATED: Forced matches are looked up by the plain ID, since they hold for every score grid. Everything else is
+    // keyed by getTableKey(), which also depends on the score grid and the selective options. Only exact win distances
+    // can be returned, since a faster win would have a different score.
+    BoardOptimalMove hashedMove = hashTable.getForcedWin(root->board.getID());
+    if (hashedMove.score != ILLEGAL) {
+        return hashedMove;
+    }
+    const unsigned long long key = getTableKey(root->board);
+    hashedMove = hashTable.getHashedMove(key, depth);
     if (hashedMove.score != ILLEGAL) {
         return hashedMove;
     }
 
+    // ADDED: Nothing beats completing a match right away, so there is no need to look at any other move
+    const Cell player = root->board.getCurPlayer();
+    MoveList moves;
+    if (root->board.getThreatCells(player, moves) > 0) {
+        return BoardOptimalMove(getWinScore(player, 1), moves[0]);
+    }
+    // Without an immediate match, the fastest possible win is on the player's next move
+    const int bestPossible = getWinScore(player, 3);
+
     // Else, we find the estimated score and optimal move of this node by calculating the score of each children node
     // Player X is trying to maximize the score, so the estimated score is the maximum of children scores
     // Vice versa, player O is trying to minimize the score
@@ -137,48 +442,99 @@ BoardOptimalMove BoardTree::getOptimalMove(const unsigned int depth)
     // BoardOptimalMove bestMove;
     BoardOptimalMove bestMove;
     // The function should work for any BOARD_SIZE
-    for (int i = 0; i < BOARD_SIZE; ++i) {
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            BoardTree* subtree = getSubTree(BoardCoordinate(i, j));
-            if (subtree->root == nullptr) {
-                continue;
-            }
-            BoardOptimalMove childMove = subtree->getOptimalMove(depth - 1);
-            if (childMove.score == ILLEGAL) {
-                continue;
+    // UPDATED: Only the empty cells are tried (only those near a stone with a candidate radius, see SearchOptions)
+    root->board.getCandidateMoves(moves, SearchOptions::getInstance().candidateRadius);
+    const unsigned long long salt = SearchOptions::getInstance().getTableSalt();
+    for (int k = 0; k < moves.count; ++k) {
+        const int i = moves[k].row, j = moves[k].col;
+        // The child probes the table first thing, so its entries are loaded while its node is created
+        hashTable.prefetch(root->board.getChildHashKey(moves[k]) ^ salt, root->board.getChildID(moves[k]));
+        BoardTree* subtree = getSubTree(moves[k]);
+        if (subtree->root == nullptr) {
+            continue;
+        }
+        BoardOptimalMove childMove = subtree->getOptimalMove(depth - 1);
+        if (childMove.score == ILLEGAL) {
+            continue;
+        }
+        // UPDATED: A match is one ply further away from this board than from the child
+        childMove.score = toParentScore(childMove.score);
+        // std::cout << "Player: " << root->board.getCurPlayer() << std::endl
+        //           << " Row, Col: " << i << ", " << j << std::endl;
+        // std::cout << "childMove.score: " << childMove.score << std::endl;
+        // std::cout << "estimatedScore: " << estimatedScore << std::endl;
+        if (root->board.getCurPlayer() == X) {
+            if (childMove.score > estimatedScore) {
+                // std::cout << "X_SCORE TRIGGERED FOR: " << childMove.score << "and " << estimatedScore << std::endl;
+                estimatedScore = childMove.score;
+                bestMove = BoardOptimalMove(estimatedScore, BoardCoordinate(i, j));
             }
-            // std::cout << "Player: " << root->board.getCurPlayer() << std::endl
-            //           << " Row, Col: " << i << ", " << j << std::endl;
-            // std::cout << "childMove.score: " << childMove.score << std::endl;
-            // std::cout << "estimatedScore: " << estimatedScore << std::endl;
-            if (root->board.getCurPlayer() == X) {
-                if (childMove.score > estimatedScore) {
-                    // std::cout << "X_SCORE TRIGGERED FOR: " << childMove.score << "and " << estimatedScore << std::endl;
-                    estimatedScore = childMove.score;
-                    bestMove = BoardOptimalMove(estimatedScore, BoardCoordinate(i, j));
-                }
-            } else {
-                if (childMove.score < estimatedScore) {
-                    // std::cout << "O_SCORE TRIGGERED FOR: " << childMove.score << "and " << estimatedScore << std::endl;
-                    estimatedScore = childMove.score;
-                    bestMove = BoardOptimalMove(estimatedScore, BoardCoordinate(i, j));
-                }
+        } else {
+            if (childMove.score < estimatedScore) {
+                // std::cout << "O_SCORE TRIGGERED FOR: " << childMove.score << "and " << estimatedScore << std::endl;
+                estimatedScore = childMove.score;
+                bestMove = BoardOptimalMove(estimatedScore, BoardCoordinate(i, j));
             }
         }
+        // ADDED: The remaining moves cannot win any faster
+        if (bestMove.score == bestPossible) {
+            break;
+        }
     }
 
     // ADDED: Store the optimal move in the hashtable
-    hashTable.updateTable(root->board.getID(), depth, bestMove);
+    // A win score means every line of play leads to a match, whatever the score grid is
+    hashTable.updateTable(key, depth, bestMove);
+    storeWin(hashTable, root->board, bestMove, depth);
 
     return bestMove;
 }
 
+// Threat extension
+// Called when the nominal depth has run out. If the player to move can complete a match, they win next move. Otherwise,
+// if the opponent can complete a match, every move except a block loses immediately, so only the blocking moves are
+// searched (for up to extension more plies). Quiet boards get their static score as usual.
+BoardOptimalMove BoardTree::getThreatExtension(const unsigned int extension)
+{
+    BoardNodePin pin(root);
+    if (root->board.isFinished()) {
+        PROFILE_SCOPE(PROFILE_EVAL);
+        return BoardOptimalMove(root->board.getBoardScore(), BoardCoordinate(0, 0));
+    }
+
+    const Cell player = root->board.getCurPlayer();
+    MoveList moves;
+    if (root->board.getThreatCells(player, moves) > 0) {
+        return BoardOptimalMove(getWinScore(player, 1), moves[0]);
+    }
+    if (extension == 0 || root->board.getThreatCells(player == X ? O : X, moves) == 0) {
+        PROFILE_SCOPE(PROFILE_EVAL);
+        return BoardOptimalMove(root->board.getBoardScore(), BoardCoordinate(0, 0));
+    }
+
+    BoardOptimalMove bestMove;
+    for (int k = 0; k < moves.count; ++k) {
+        BoardTree* subtree = getSubTree(moves[k]);
+        if (subtree->root == nullptr) {
+            continue;
+        }
+        SearchStats::getInstance().nodes++;
+        BoardOptimalMove childMove = subtree->getThreatExtension(extension - 1);
+        childMove.score = toParentScore(childMove.score);
+        if (bestMove.score == ILLEGAL
+            || (player == X && childMove.score > bestMove.score)
+            || (player == O && childMove.score < bestMove.score)) {
+            bestMove = BoardOptimalMove(childMove.score, moves[k]);
+        }
+    }
+    return bestMove;
+}
+
 // Alpha-beta pruning
 // In this case, we keep track of the "best score found by the opponent"
 // Implement an alternative version of getOptimalMove() that uses alpha-beta pruning.
 // Do this by keeping track of two extra variables: alpha and beta.
 // You can copy the getoptimalmove function and edit it sa per the pseudocode below.
-// DO NOT use transposition tables for this part.
 // Alpha is the best score found by the maximizing player (X) so far.
 // Beta is the best score found by the minimizing player (O) so far.
 // Depending on the current player, if a child node is found to have a "worse" score for the opponent, we can exit early.
@@ -220,6 +576,8 @@ BoardOptimalMove BoardTree::getOptimalMove(const unsigned int depth)
 //
 // Note that, we exit the loop if a "worse" board state for the opponent is found.
 // Careful when using 'break' as it will only break from 1 for loop
+// UPDATED: Results are now stored in the transposition table together with the kind of bound they represent, and the
+// stored move is searched first.
 
 BoardOptimalMove BoardTree::getOptimalMoveAlphaBeta(const unsigned int depth, int alpha, int beta)
 {
@@ -230,6 +588,8 @@ BoardOptimalMove BoardTree::getOptimalMoveAlphaBeta(const unsigned int depth, in
     if (root == nullptr) {
         return BoardOptimalMove();
     }
+    SearchStats::getInstance().nodes++;
+    BoardNodePin pin(root);
 
     // if (depth == 0 || board is finished) {
     // If depth is 0 or if the game has already finished, we cannot search further
@@ -237,9 +597,50 @@ BoardOptimalMove BoardTree::getOptimalMoveAlphaBeta(const unsigned int depth, in
     // return BoardOptimalMove(board score, any coordinates);
     // }
     if (depth == 0 || root->board.isFinished()) {
+        // ADDED: A static score is misleading if a match can be completed next move, so search the forcing moves further
+        if (depth == 0 && SearchOptions::getInstance().threatExtension && !root->board.isFinished()) {
+            return getThreatExtension(SearchOptions::getInstance().maxExtension);
+        }
+        PROFILE_SCOPE(PROFILE_EVAL);
         return BoardOptimalMove(root->board.getBoardScore(), BoardCoordinate(0, 0));
     }
 
+    // The table is shared with getOptimalMove(). Forced wins and exact scores can be returned directly, and bounds can
+    // still cut off this node if they already fall outside the window. A forced win whose distance is only an upper bound
+    // is such a bound too: the winner wins at least that fast.
+    BoardHashTable& hashTable = SearchOptions::getInstance().getHashTable();
+    bool exactWin = false;
+    BoardOptimalMove hashedMove = hashTable.getForcedWin(root->board.getID(), exactWin);
+    if (hashedMove.score != ILLEGAL && (exactWin || (hashedMove.score > 0 && hashedMove.score > beta)
+                                                 || (hashedMove.score < 0 && hashedMove.score < alpha))) {
+        return hashedMove;
+    }
+    const unsigned long long id = getTableKey(root->board);
+    hashedMove = hashTable.getHashedMove(id, depth, alpha, beta);
+    if (hashedMove.score != ILLEGAL) {
+        return hashedMove;
+    }
+
+    // Nothing beats completing a match right away
+    const Cell player = root->board.getCurPlayer();
+    MoveList moves;
+    if (root->board.getThreatCells(player, moves) > 0) {
+        return BoardOptimalMove(getWinScore(player, 1), moves[0]);
+    }
+
+    // Mate distance pruning: from here, the player wins on their next move at the earliest, and loses on the
+    // opponent's move at the latest. If the window lies outside of that range, the result is already known to fail.
+    const int bestPossible = getWinScore(player, 3);
+    const int worstPossible = getWinScore(player == X ? O : X, 2);
+    if ((player == X && alpha >= bestPossible) || (player == O && beta <= bestPossible)) {
+        return BoardOptimalMove(bestPossible, BoardCoordinate(0, 0));
+    }
+    if ((player == X && beta <= worstPossible) || (player == O && alpha >= worstPossible)) {
+        return BoardOptimalMove(worstPossible, BoardCoordinate(0, 0));
+    }
+    const int originalAlpha = alpha;
+    const int originalBeta = beta;
+
     // Else, we find the estimated score and optimal move of this node by calculating the score of each children node
     // Player X is trying to maximize the score, so the estimated score is the maximum of children scores
     // Vice versa, player O is trying to minimize the score
@@ -248,51 +649,263 @@ BoardOptimalMove BoardTree::getOptimalMoveAlphaBeta(const unsigned int depth, in
 
     int estimatedScore = (root->board.getCurPlayer() == X) ? -50000 : 50000;
 
+    // Search the move stored in the table first (usually the best move of a shallower search), then all other cells.
+    // Good moves early give narrower windows for the rest and therefore more cutoffs.
+    const BoardCoordinate hashedCoords = hashTable.getHashedCoords(id);
+    const int firstCell = hashedCoords.isValid() ? hashedCoords.row * BOARD_SIZE + hashedCoords.col : -1;
+
+    // Only the empty (candidate) cells are tried, with the stored move moved to the front. The other moves keep their order.
+    root->board.getCandidateMoves(moves, SearchOptions::getInstance().candidateRadius);
+    for (int k = 1; k < moves.count; ++k) {
+        if (moves.cells[k] == firstCell) {
+            std::rotate(moves.cells, moves.cells + k, moves.cells + k + 1);
+            break;
+        }
+    }
+
+    // Selective search needs the good moves early and the bad ones late. After the stored move come the cells that block
+    // a match of the opponent, then all others from the most to the least valuable cell.
+    const SearchOptions& options = SearchOptions::getInstance();
+    SearchStats& stats = SearchStats::getInstance();
+    const bool futility = options.futilityPruning && !options.threatExtension && depth <= FUTILITY_MAX_DEPTH;
+    const bool reductions = options.lateMoveReductions && depth >= LMR_MIN_DEPTH;
+    MoveList blocks;
+    int tacticalMoves = 0;
+    if (futility || reductions) {
+        root->board.getThreatCells(player == X ? O : X, blocks);
+        auto getOrder = [&](const int cell) {
+            const BoardCoordinate coords(cell / BOARD_SIZE, cell % BOARD_SIZE);
+            return cell == firstCell ? 2 * WIN_SCORE : blocks.contains(coords) ? WIN_SCORE : root->board.getCellScore(coords);
+        };
+        std::stable_sort(moves.cells, moves.cells + moves.count, [&](const int a, const int b) { return getOrder(a) > getOrder(b); });
+        tacticalMoves = blocks.count + (firstCell >= 0 ? 1 : 0);
+    }
+    // Without a match in the next two plies, a child is worth the current material plus its own cell, and at depth 2 the
+    // opponent's reply. The opponent can at least take the most valuable other cell (every move here is still available
+    // to the child), so that cell limits what the child can be worth for the player, whatever the signs of the scores.
+    const int material = root->board.getBoardScore();
+    int bestReply = -1, secondReply = -1;
+    if (futility && depth == 2) {
+        for (int k = 0; k < moves.count; ++k) {
+            const int cellScore = root->board.getCellScore(moves[k]);
+            if (bestReply < 0 || cellScore > root->board.getCellScore(moves[bestReply])) {
+                secondReply = bestReply;
+                bestReply = k;
+            } else if (secondReply < 0 || cellScore > root->board.getCellScore(moves[secondReply])) {
+                secondReply = k;
+            }
+        }
+    }
+
     // BoardOptimalMove bestMove;
     BoardOptimalMove bestMove;
     // The function should work for any BOARD_SIZE
-    for (int i = 0; i < BOARD_SIZE; ++i) {
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            BoardTree* subtree = getSubTree(BoardCoordinate(i, j));
-            if (subtree->root == nullptr) {
+    for (int k = 0; k < moves.count; ++k) {
+        const int i = moves[k].row, j = moves[k].col;
+        // The child probes the table first thing, so its entries are loaded while its node is created
+        hashTable.prefetch(root->board.getChildHashKey(moves[k]) ^ options.getTableSalt(), root->board.getChildID(moves[k]));
+        BoardTree* subtree = getSubTree(moves[k]);
+        if (subtree->root == nullptr) {
+            continue;
+        }
+        // Futility pruning: if even the bound of this move does not reach the window, the child cannot either. Its bound
+        // still counts as the score of the move, so the result stays an upper (or lower) bound. Like the cutoffs below,
+        // only bounds strictly outside of the window prune, since a score on its edge counts as exact.
+        // The bound only holds for a search of the child to depth - 1. Table entries of deeper searches (from earlier
+        // moves) can be worth more, so this is a selective search. Known forced wins of the child are never pruned.
+        bool exactChildWin = false;
+        if (futility && hashTable.getForcedWin(root->board.getChildID(moves[k]), exactChildWin).score == ILLEGAL) {
+            int bound = material + player * getCellWeight(player) * root->board.getCellScore(moves[k]);
+            const int reply = (k == bestReply) ? secondReply : bestReply;
+            if (reply >= 0) {
+                const Cell opponent = (player == X) ? O : X;
+                bound += opponent * getCellWeight(opponent) * root->board.getCellScore(moves[reply]);
+            }
+            if ((player == X && bound < alpha) || (player == O && bound > beta)) {
+                stats.futilityPrunes++;
+                if ((player == X && bound > estimatedScore) || (player == O && bound < estimatedScore)) {
+                    estimatedScore = bound;
+                    bestMove = BoardOptimalMove(bound, BoardCoordinate(i, j));
+                }
                 continue;
             }
-            // MODIFIED: Call the alpha-beta pruning variant
-            BoardOptimalMove childMove = subtree->getOptimalMoveAlphaBeta(depth - 1, alpha, beta);
+        }
 
-            if (childMove.score == ILLEGAL) {
-                continue;
+        // MODIFIED: Call the alpha-beta pruning variant
+        // The child's scores are one ply closer to a match, so the window is converted to and the result from its view
+        BoardOptimalMove childMove;
+        if (reductions && k >= std::max(LMR_FULL_MOVES, tacticalMoves)) {
+            // Late move reduction, verified at the full depth if the move beats the best move so far
+            stats.reductions++;
+            childMove = subtree->getOptimalMoveAlphaBeta(depth - 2, toChildScore(alpha), toChildScore(beta));
+            const int reducedScore = toParentScore(childMove.score);
+            if (childMove.score != ILLEGAL && ((player == X && reducedScore > alpha) || (player == O && reducedScore < beta))) {
+                stats.verifications++;
+                childMove = subtree->getOptimalMoveAlphaBeta(depth - 1, toChildScore(alpha), toChildScore(beta));
             }
-            if (root->board.getCurPlayer() == X) {
-                if (childMove.score > estimatedScore) {
-                    // std::cout << "X_SCORE TRIGGERED FOR: " << childMove.score << "and " << estimatedScore << std::endl;
-                    estimatedScore = childMove.score;
-                    bestMove = BoardOptimalMove(estimatedScore, BoardCoordinate(i, j));
-                }
-            } else {
-                if (childMove.score < estimatedScore) {
-                    // std::cout << "O_SCORE TRIGGERED FOR: " << childMove.score << "and " << estimatedScore << std::endl;
-                    estimatedScore = childMove.score;
-                    bestMove = BoardOptimalMove(estimatedScore, BoardCoordinate(i, j));
-                }
+        } else {
+            childMove = subtree->getOptimalMoveAlphaBeta(depth - 1, toChildScore(alpha), toChildScore(beta));
+        }
+
+        if (childMove.score == ILLEGAL) {
+            continue;
+        }
+        childMove.score = toParentScore(childMove.score);
+        if (root->board.getCurPlayer() == X) {
+            if (childMove.score > estimatedScore) {
+                estimatedScore = childMove.score;
+                bestMove = BoardOptimalMove(estimatedScore, BoardCoordinate(i, j));
             }
+        } else {
+            if (childMove.score < estimatedScore) {
+                estimatedScore = childMove.score;
+                bestMove = BoardOptimalMove(estimatedScore, BoardCoordinate(i, j));
+            }
+        }
+        // The remaining moves cannot win any faster
+        if (bestMove.score == bestPossible) {
+            break;
+        }
         // ADDED: Update alpha and beta according to newest child score found
-        if (root->board.getCurPlayer() == X) {
+        if (player == X) {
             if (bestMove.score > beta) {
                 // Found a move that would be worse for O, so O will not consider this subtree
-                return bestMove;
+                break;
             }
             // Update the best move found by X
             alpha = std::max(bestMove.score, alpha);
         } else {
             // Same logic but for current player O
             if (bestMove.score < alpha) {
-                return bestMove;
+                break;
             }
             beta = std::min(bestMove.score, beta);
         }
-        }
+    }
+
+    // Scores outside of the original window are only bounds
+    BoardHashBound bound = EXACT;
+    if (bestMove.score <= originalAlpha) {
+        bound = UPPER;
+    } else if (bestMove.score >= originalBeta) {
+        bound = LOWER;
+    }
+    hashTable.updateTable(id, depth, bestMove, bound);
+    // A bound on the winner's side proves a match too, but only an exact score has the right distance
+    if (bound == EXACT) {
+        storeWin(hashTable, root->board, bestMove, depth);
     }
 
     return bestMove;
 }
+
+
+// BoardSearchResult constructor
+BoardSearchResult::BoardSearchResult()
+{
+    for (int i = 0; i < BOARD_SIZE; ++i) {
+        for (int j = 0; j < BOARD_SIZE; ++j) {
+            moveScores[i][j] = ILLEGAL;
+        }
+    }
+}
+
+// Search result with the scores of all moves
+// Like getOptimalMove(), but the root does not pass its window on to the children, so no child is cut off and every
+// child score is exact. Below the root, alpha-beta prunes as usual. The principal variation is read back from the
+// transposition table: starting from the best move, it follows the moves of forced wins and of exact entries searched at
+// least as deep as the plies left. Bounds only store the move that caused a cutoff, which need not be the best reply.
+BoardSearchResult BoardTree::getSearchResult(const unsigned int depth, const bool alphabeta)
+{
+    BoardSearchResult result;
+    if (root == nullptr) {
+        return result;
+    }
+    if (depth == 0 || root->board.isFinished()) {
+        result.best = alphabeta ? getOptimalMoveAlphaBeta(depth, -WIN_SCORE - 1, WIN_SCORE + 1) : getOptimalMove(depth);
+        return result;
+    }
+    SearchStats::getInstance().nodes++;
+    BoardNodePin pin(root);
+
+    const Cell player = root->board.getCurPlayer();
+    MoveList moves;
+    root->board.getCandidateMoves(moves, SearchOptions::getInstance().candidateRadius);
+    for (int k = 0; k < moves.count; ++k) {
+        BoardTree* subtree = getSubTree(moves[k]);
+        if (subtree->root == nullptr) {
+            continue;
+        }
+        BoardOptimalMove childMove = alphabeta ? subtree->getOptimalMoveAlphaBeta(depth - 1, -WIN_SCORE - 1, WIN_SCORE + 1)
+                                               : subtree->getOptimalMove(depth - 1);
+        if (childMove.score == ILLEGAL) {
+            continue;
+        }
+        childMove.score = toParentScore(childMove.score);
+        result.moveScores[moves[k].row][moves[k].col] = childMove.score;
+        if (result.best.score == ILLEGAL
+            || (player == X && childMove.score > result.best.score)
+            || (player == O && childMove.score < result.best.score)) {
+            result.best = BoardOptimalMove(childMove.score, moves[k]);
+        }
+    }
+
+    BoardHashTable& hashTable = SearchOptions::getInstance().getHashTable();
+    hashTable.updateTable(getTableKey(root->board), depth, result.best);
+    storeWin(hashTable, root->board, result.best, depth);
+
+    // Follow the stored moves for as many plies as were searched. A position can be missing from the table (replaced,
+    // or never stored because it was a leaf) or only hold a bound, which ends the variation early.
+    Board board = root->board;
+    BoardCoordinate coords = result.best.coords;
+    for (unsigned int ply = 0; ply < depth && coords.isValid() && board.play(coords); ++ply) {
+        result.pv.add(coords);
+        if (board.isFinished() || ply + 1 == depth) {
+            break;
+        }
+        BoardOptimalMove stored = hashTable.getForcedWin(board.getID());
+        if (stored.score == ILLEGAL) {
+            stored = hashTable.getHashedMove(getTableKey(board), depth - ply - 1);
+        }
+        coords = stored.coords;
+    }
+    return result;
+}
+
+// Aspiration windows
+// A search with a narrow window [alpha, beta] prunes much more than one with the full window. If the true score lies
+// inside the window the result is exact, otherwise the result is only a bound (fail low if score <= alpha, fail high if
+// score >= beta) and the search is repeated with a wider window on the failing side. Scores of consecutive depths are
+// usually close, and the subtrees built by the previous depth are reused, so the re-searches are cheap.
+BoardOptimalMove BoardTree::getOptimalMoveAspiration(const unsigned int depth, const int guess)
+{
+    if (root == nullptr) {
+        return BoardOptimalMove();
+    }
+
+    SearchStats& stats = SearchStats::getInstance();
+    BoardOptimalMove bestMove;
+    int score = guess;
+    for (unsigned int currentDepth = 1; currentDepth <= depth; ++currentDepth) {
+        int lowWindow = ASPIRATION_WINDOW;
+        int highWindow = ASPIRATION_WINDOW;
+        while (true) {
+            const int alpha = std::max(score - lowWindow, -WIN_SCORE - 1);
+            const int beta = std::min(score + highWindow, WIN_SCORE + 1);
+            bestMove = getOptimalMoveAlphaBeta(currentDepth, alpha, beta);
+            if (bestMove.score <= alpha && alpha > -WIN_SCORE - 1) {
+                lowWindow *= 4;
+            } else if (bestMove.score >= beta && beta < WIN_SCORE + 1) {
+                highWindow *= 4;
+            } else {
+                break;
+            }
+            stats.reSearches++;
+        }
+        score = bestMove.score;
+        if (root->board.isFinished()) {
+            break;
+        }
+    }
+    return bestMove;
+}
\ No newline at end of file
@@ -1,16 +1,62 @@
 #ifndef __BOARDTREE_H__
 #define __BOARDTREE_H__
 
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include "board.h"
 #include "hashtable.h"
+#include "search.h"
 
 struct BoardNode;
 
+// Memory accounting of one tree. It is owned by the node at the top of the tree and shared by all nodes below it.
+// Nodes are kept in a list ordered by last use, so that the coldest subtrees can be collapsed when the tree grows
+// beyond SearchOptions::treeMB.
+struct BoardTreeBudget {
+    unsigned long long nodeCount {0}; // Number of nodes in the tree
+    BoardNode* newest {nullptr};      // Most recently used node
+    BoardNode* oldest {nullptr};      // Least recently used node, evicted first
+
+    // Move node to the newest end of the list
+    void touch(BoardNode* node);
+    // Add a new node at the newest end of the list
+    void link(BoardNode* node);
+    // Remove node from the list
+    void unlink(BoardNode* node);
+};
+
+// Result of BoardTree::getSearchResult(): the best move together with the score of every move at the root and the
+// expected continuation.
+struct BoardSearchResult {
+    BoardOptimalMove best;                          // Same as the result of getOptimalMove()
+    int moveScores[BOARD_SIZE][BOARD_SIZE];         // Score of playing at each cell, ILLEGAL for occupied cells and non-candidates
+    MoveList pv;                                    // Principal variation: best, then the best reply, and so on
+
+    BoardSearchResult();
+};
+
 class BoardTree {
+    friend class BoardTreeReclaimer;
+
     private:
         BoardNode* root {nullptr};
 
+        // Delete node and everything below it. Iterative, so the depth of the tree does not matter.
+        static void destroy(BoardNode* node);
+
+        // Remove node and everything below it from the budget of their tree, making node the top of a tree without a budget
+        static void detach(BoardNode* node);
+
+        // Search only forcing moves, for up to extension plies, after the nominal depth has run out
+        BoardOptimalMove getThreatExtension(const unsigned int extension);
+
+        // Collapse the least recently used subtrees that are not being searched until the tree fits in maxNodes nodes.
+        // keep is never collapsed.
+        static void evict(BoardTreeBudget& budget, const unsigned long long maxNodes, const BoardNode* keep);
+
     public:
         // Default empty constructor
         BoardTree() = default;
@@ -25,7 +71,16 @@ class BoardTree {
 
         bool isEmpty() const { return root == nullptr; }
 
+        // Delete all nodes, leaving an empty tree. If background is true, the nodes are handed to BoardTreeReclaimer and
+        // deleted by its thread, so this returns without waiting for the memory to be freed.
+        void clear(const bool background = false);
+
+        // Clear every subtree except the one at keep, e.g. the moves that were not played. See clear().
+        void clearSubTrees(const BoardCoordinate& keep, const bool background = false);
+
         // Return a pointer to the subtree at the given coordinates. Build the tree if it is empty.
+        // While a search is running, building a subtree may collapse cold subtrees (see SearchOptions::treeMB). Their
+        // results are still in the transposition table, and they are built again if they are needed.
         BoardTree* getSubTree(const BoardCoordinate& coords);
 
         // Calculate the best move by searching the tree up to depth moves ahead
@@ -33,13 +88,60 @@ class BoardTree {
 
         // Same as above but utilizes alpha-beta pruning
         BoardOptimalMove getOptimalMoveAlphaBeta(const unsigned int depth, int alpha, int beta);
+
+        // Search every move at the root to depth and return all their scores, the best move and the principal variation.
+        // Each move is searched with the full window (minimax or alpha-beta), so all scores are exact. This is a
+        // single search, and much cheaper than calling getOptimalMove() on every subtree, since the transposition
+        // table is shared by all moves.
+        BoardSearchResult getSearchResult(const unsigned int depth, const bool alphabeta);
+
+        // Iterative deepening alpha-beta search with aspiration windows. Each depth starts with a narrow window around the
+        // score of the previous depth (guess for the first one), which is widened and searched again when the result falls outside.
+        BoardOptimalMove getOptimalMoveAspiration(const unsigned int depth, const int guess);
+};
+
+// Background thread deleting the trees passed to BoardTree::clear(true). There is a single instance, whose thread is
+// started by the first tree. Trees still queued at exit are deleted before the program ends.
+class BoardTreeReclaimer {
+    private:
+        std::thread worker;
+        std::mutex mutex;
+        std::condition_variable queueChanged;
+        std::vector<BoardNode*> queue; // Detached trees waiting to be deleted
+        bool stopping {false};
+
+        BoardTreeReclaimer() = default;
+        void workerLoop();
+
+    public:
+        ~BoardTreeReclaimer();
+        BoardTreeReclaimer(const BoardTreeReclaimer&) = delete;
+        BoardTreeReclaimer& operator=(const BoardTreeReclaimer&) = delete;
+
+        // Return the only instance of BoardTreeReclaimer
+        static BoardTreeReclaimer& getInstance()
+        {
+            static BoardTreeReclaimer instance;
+            return instance;
+        }
+
+        // Queue a detached tree (no parent and no budget, see BoardTree::clear) for deletion
+        void reclaim(BoardNode* node);
 };
 
 struct BoardNode {
     const Board board; // Current board state
     BoardTree subTree[BOARD_SIZE][BOARD_SIZE]; // One sub-tree for each possible next move
 
-    BoardNode(const Board& board): board(board) {}
+    BoardNode* parent;        // Node of the previous move, nullptr at the top of the tree
+    BoardTree* owner;         // Tree whose root is this node
+    BoardTreeBudget* budget;  // Memory accounting of the whole tree, nullptr once the node is detached from it
+    BoardNode* older {nullptr}; // Neighbours in the budget's list
+    BoardNode* newer {nullptr};
+    unsigned int pins {0};    // Number of searches running on this node or below it. Pinned nodes are never collapsed.
+
+    BoardNode(const Board& board, BoardNode* parent, BoardTree* owner, BoardTreeBudget* budget);
+    ~BoardNode();
     BoardNode(const BoardNode& node) = delete;
     BoardNode& operator=(const BoardNode& node) = delete;
 };
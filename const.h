@@ -4,12 +4,17 @@
 #include <iostream>
 #include <cmath>
 
-// Board size and table size. To try 4x4 mode, comment the following 2 lines and uncomment the bottom 2, then change SCORE_PRESET accordingly.
+// Board size. To try 3x3 mode, comment the bottom line and uncomment the following one, then change SCORE_PRESET accordingly.
 // const int BOARD_SIZE = 3;
-// const int TABLE_SIZE = 101;
 
 const int BOARD_SIZE = 4;
-const int TABLE_SIZE = 200009;
+
+// Number of cells of one player in a row, column or diagonal needed for a match. The course rules use the whole line, but
+// larger boards are only playable with a shorter one, e.g. 7x7 with 4 or 15x15 with 5 (gomoku).
+const int WIN_LENGTH = BOARD_SIZE;
+
+// Default size of the transposition table in megabytes. It can be changed at runtime with BoardHashTable::resize().
+const unsigned int HASH_MB_PRESET = 16;
 
 // Constants representing "score of a winning player" and "illegal score".
 const int WIN_SCORE = 10000;
@@ -28,12 +33,74 @@ const int SCORE_PRESET[BOARD_SIZE][BOARD_SIZE] = {
 // Default search depth
 const int DEPTH_PRESET = 7;
 
+// Default maximum number of extra plies searched by the threat extension
+const unsigned int THREAT_EXTENSION_PRESET = 4;
+
+// Initial half width of the aspiration window around the expected score
+const int ASPIRATION_WINDOW = 100;
+
+// Default radius of the candidate moves (see Board::getCandidateMoves()), 0 to search every empty cell. Large boards
+// need a small radius to keep the branching factor down.
+const int CANDIDATE_RADIUS_PRESET = 0;
+
+// Late move reductions: the first LMR_FULL_MOVES moves of a node are always searched to the full depth, and only nodes
+// with at least LMR_MIN_DEPTH plies left reduce the others (by one ply)
+const int LMR_FULL_MOVES = 3;
+const unsigned int LMR_MIN_DEPTH = 3;
+
+// Futility pruning is only used this close to the leaves, where the static score of a move and its reply can be bounded
+const unsigned int FUTILITY_MAX_DEPTH = 2;
+
+// Default playout budget and UCT exploration constant of the MCTS engine
+const unsigned int MCTS_ITERATIONS_PRESET = 20000;
+const double MCTS_EXPLORATION = 1.41421356;
+
+// Default number of entries and node budget of the proof-number search. It runs before every move, so the budget keeps a
+// failed proof about as cheap as the alpha-beta search that follows it, and the table small enough to stay in the cache.
+const unsigned int PN_TABLE_SIZE = 1 << 16;
+const unsigned long long PN_NODE_LIMIT = 10000;
+
+// Maximum number of scopes recorded for the Chrome trace of the phase profiler (see profiler.h)
+const unsigned long long PROFILE_TRACE_EVENTS = 1 << 20;
+
 enum Cell {
     EMPTY = 0,
     X = 1,
     O = -1,
 };
 
+// Search scores of a match. A match on the board is worth WIN_SCORE (or -WIN_SCORE), and every ply between a position
+// and the match moves its score one step towards 0. A faster win therefore scores higher, and a slower loss scores
+// better for the losing side. Scores are relative to the position they belong to, so they can be stored in the
+// transposition table as they are. Material scores stay far below WIN_SCORE - MAX_PLIES.
+const int MAX_PLIES = BOARD_SIZE * BOARD_SIZE;
+
+// Score of a match by winner, plies moves after the position
+constexpr int getWinScore(const Cell winner, const int plies) {
+    return winner * (WIN_SCORE - plies);
+}
+
+// Return true if score is a match, i.e. a board score of WIN_SCORE or -WIN_SCORE seen from some plies before
+constexpr bool isWinScore(const int score) {
+    return (score >= WIN_SCORE - MAX_PLIES && score <= WIN_SCORE) || (score <= -(WIN_SCORE - MAX_PLIES) && score >= -WIN_SCORE);
+}
+
+// Number of plies until the match of a win score
+constexpr int getWinDistance(const int score) {
+    return score > 0 ? WIN_SCORE - score : WIN_SCORE + score;
+}
+
+// Convert the score of a position to the score of its parent, one ply further away from the match
+constexpr int toParentScore(const int score) {
+    return !isWinScore(score) ? score : score > 0 ? score - 1 : score + 1;
+}
+
+// Inverse of toParentScore(), used to pass the window of a position on to its children
+constexpr int toChildScore(const int score) {
+    return (score >= WIN_SCORE - MAX_PLIES - 1 && score <= WIN_SCORE - 1) ? score + 1
+         : (score <= -(WIN_SCORE - MAX_PLIES - 1) && score >= -(WIN_SCORE - 1)) ? score - 1 : score;
+}
+
 // Helper function to get the character representing the player. You don't need to use this function.
 const char cellChr[3] {'O', ' ', 'X'};
 static const char cell2chr(const Cell c) {
@@ -42,32 +109,33 @@ static const char cell2chr(const Cell c) {
 
 // Helper function for printing any grid. You don't need to use this function.
 // T2C is a function pointer parameter, which can accept a lambda or a function name
+// Rows end with '\n' instead of std::endl, so printing a board does not flush the stream once per row.
 template<typename T, typename C>
 void printBoard(std::ostream &os, T grid[BOARD_SIZE][BOARD_SIZE], C(*T2C)(const T)) {
     for (int j=0; j<BOARD_SIZE; ++j) {
         os << "====";
         if (j == BOARD_SIZE - 1) os << "=";
     }
-    os << std::endl;
+    os << '\n';
     for (int i=0; i<BOARD_SIZE; ++i) {
         os << "| ";
         for (int j=0; j<BOARD_SIZE; ++j) {
             os << T2C(grid[i][j]);
             if (j != BOARD_SIZE - 1) os << " | ";
         }
-        os << " |" << std::endl;
+        os << " |" << '\n';
         for (int j=0; j<BOARD_SIZE; ++j) {
             os << "====";
             if (j == BOARD_SIZE - 1) os << "=";
         }
-        os << std::endl;
+        os << '\n';
     }
 }
 
 // Helper function for getting the score scaling for each player.
 // You should multiply X's score with number of moves O can play, and vice versa.
-const int cellWeight[3] {(BOARD_SIZE * BOARD_SIZE + 1) / 2, 1, (BOARD_SIZE * BOARD_SIZE + 0) / 2};
-static const int getCellWeight(const Cell c) {
+constexpr int cellWeight[3] {(BOARD_SIZE * BOARD_SIZE + 1) / 2, 1, (BOARD_SIZE * BOARD_SIZE + 0) / 2};
+constexpr int getCellWeight(const Cell c) {
     return cellWeight[static_cast<int>(c) + 1];
 }
 
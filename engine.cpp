@@ -0,0 +1,141 @@
+#include <chrono>
+#include <cstdlib>
+#include "engine.h"
+#include "boardtree.h"
+#include "proofsearch.h"
+#include "search.h"
+
+// parseSearchLimits
+//  Shared by the command line tools that take engine descriptions
+bool parseSearchLimits(const std::string& text, SearchLimits& limits)
+{
+    const size_t plus = text.find('+');
+    const std::string engine = text.substr(0, plus);
+    const size_t colon = engine.find(':');
+    const std::string algorithm = engine.substr(0, colon);
+    const int value = (colon == std::string::npos) ? 0 : atoi(engine.c_str() + colon + 1);
+    if (algorithm == "minimax") limits.algorithm = SearchLimits::MINIMAX;
+    else if (algorithm == "alphabeta") limits.algorithm = SearchLimits::ALPHABETA;
+    else if (algorithm == "aspiration") limits.algorithm = SearchLimits::ASPIRATION;
+    else if (algorithm == "mcts") limits.algorithm = SearchLimits::MCTS;
+    else return false;
+
+    if (limits.algorithm == SearchLimits::MCTS) {
+        if (value > 0) limits.mcts.iterations = value;
+    }
+    else if (value > 0) {
+        limits.depth = value;
+    }
+
+    for (size_t begin = plus; begin != std::string::npos; ) {
+        const size_t end = text.find('+', begin + 1);
+        const std::string suffix = text.substr(begin + 1, end == std::string::npos ? std::string::npos : end - begin - 1);
+        if (suffix == "lmr") limits.reductions = true;
+        else if (suffix == "futility") limits.futility = true;
+        else return false;
+        begin = end;
+    }
+    return true;
+}
+
+Engine::Engine(const unsigned int hashMB): hashTable(new BoardHashTable(hashMB))
+{
+}
+
+Engine::~Engine()
+{
+    delete hashTable;
+    delete prover;
+}
+
+// SearchStateGuard
+//  Saves the SearchOptions and SearchStats of the calling thread and restores them when it goes out of scope, so a search
+//  leaves them unchanged even if it throws (e.g. bad_alloc while the tree or the prover is allocated).
+class SearchStateGuard {
+    private:
+        SearchOptions& options;
+        SearchStats& stats;
+        const SearchOptions savedOptions;
+        const SearchStats savedStats;
+
+    public:
+        SearchStateGuard(): options(SearchOptions::getInstance()), stats(SearchStats::getInstance()),
+            savedOptions(options), savedStats(stats) {}
+        ~SearchStateGuard()
+        {
+            options = savedOptions;
+            stats = savedStats;
+        }
+        SearchStateGuard(const SearchStateGuard&) = delete;
+        SearchStateGuard& operator=(const SearchStateGuard&) = delete;
+};
+
+// Engine::search
+//  The BoardTree search functions read their options from the SearchOptions of the calling thread, so they are pointed at
+//  this engine's table for the duration of the search and restored afterwards. The tree is built from scratch for
+//  every search, and only the transposition table carries knowledge from one search to the next.
+SearchResult Engine::search(const Board& position, const SearchLimits& limits)
+{
+    SearchResult result;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+    SearchStateGuard guard;
+    SearchOptions& options = SearchOptions::getInstance();
+    options.hashTable = hashTable;
+    hashTable->newSearch();
+    options.threatExtension = limits.threatExtension;
+    options.treeMB = limits.treeMB;
+    options.candidateRadius = limits.candidateRadius;
+    options.lateMoveReductions = limits.reductions;
+    options.futilityPruning = limits.futility;
+
+    SearchStats& stats = SearchStats::getInstance();
+    stats.reset();
+
+    if (limits.prove && !position.isFinished()) {
+        // The proof table (PN_TABLE_SIZE entries) is only allocated once per engine
+        if (prover == nullptr) {
+            prover = new ProofNumberSearch();
+        }
+        ProofOutcome outcome = prover->prove(position, position.getCurPlayer());
+        result.nodes += outcome.nodes;
+        if (outcome.result == PROVEN && outcome.move.isValid()) {
+            result.move = BoardOptimalMove(outcome.score, outcome.move);
+            result.provenWin = true;
+        }
+    }
+
+    if (!result.provenWin) {
+        if (limits.algorithm == SearchLimits::MCTS) {
+            MCTSLimits mctsLimits = limits.mcts;
+            mctsLimits.candidateRadius = limits.candidateRadius;
+            MCTSEngine mcts{mctsLimits};
+            result.move = mcts.getOptimalMove(position);
+            result.nodes += mcts.getIterations();
+        }
+        else {
+            BoardTree tree{position};
+            if (limits.algorithm == SearchLimits::MINIMAX)
+                result.move = tree.getOptimalMove(limits.depth);
+            else if (limits.algorithm == SearchLimits::ALPHABETA)
+                result.move = tree.getOptimalMoveAlphaBeta(limits.depth, -WIN_SCORE - 1, WIN_SCORE + 1);
+            else
+                result.move = tree.getOptimalMoveAspiration(limits.depth, limits.guess);
+            result.nodes += stats.nodes;
+            result.reSearches = stats.reSearches;
+        }
+    }
+
+    result.timeUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+    return result;
+}
+
+// Engine::clear
+//  Empty the transposition table and the proof table of this engine.
+void Engine::clear()
+{
+    hashTable->clearTable();
+    if (prover != nullptr) {
+        prover->clearTable();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#ifndef __ENGINE_H__
+#define __ENGINE_H__
+
+#include <string>
+#include "board.h"
+#include "const.h"
+#include "hashtable.h"
+#include "mcts.h"
+
+// What to search and how far. The defaults match main_program.cpp with -ab.
+struct SearchLimits {
+    enum Algorithm {
+        MINIMAX,    // BoardTree::getOptimalMove
+        ALPHABETA,  // BoardTree::getOptimalMoveAlphaBeta with the full window
+        ASPIRATION, // BoardTree::getOptimalMoveAspiration
+        MCTS,       // MCTSEngine, limited by mcts instead of depth
+    };
+
+    Algorithm algorithm {ALPHABETA};
+    unsigned int depth {DEPTH_PRESET};
+    bool threatExtension {false};  // See SearchOptions::threatExtension
+    bool reductions {false};       // See SearchOptions::lateMoveReductions
+    bool futility {false};         // See SearchOptions::futilityPruning
+    unsigned int treeMB {0};       // See SearchOptions::treeMB
+    int candidateRadius {CANDIDATE_RADIUS_PRESET}; // See SearchOptions::candidateRadius, also used for mcts
+    bool prove {false};            // Check for a forced win with ProofNumberSearch before searching
+    int guess {0};                 // Expected score, used to center the first aspiration window
+    MCTSLimits mcts;
+};
+
+// Parse an engine description such as "alphabeta:6" into limits. The algorithm is one of minimax, alphabeta, aspiration
+// or mcts, and the optional number is the depth (the playout budget for mcts). The alpha-beta searches also accept the
+// suffixes "+lmr" and "+futility", e.g. "alphabeta:8+lmr+futility". Return false for an unknown algorithm or suffix.
+bool parseSearchLimits(const std::string& text, SearchLimits& limits);
+
+struct SearchResult {
+    BoardOptimalMove move;           // Best move and its score, or an illegal move if the game has finished
+    bool provenWin {false};          // move is a forced win found by the proof-number search
+    unsigned long long nodes {0};    // Nodes (or MCTS playouts) searched
+    unsigned int reSearches {0};     // Aspiration window re-searches
+    long long timeUs {0};            // Wall clock time of the search in microseconds
+};
+
+class ProofNumberSearch;
+
+// Self-contained search engine. Each Engine owns its transposition table, so several engines can run in one process,
+// each on its own thread, without sharing any state. A single Engine must not be used by two threads at the same time.
+class Engine {
+    private:
+        BoardHashTable* hashTable;
+        ProofNumberSearch* prover {nullptr}; // Created by the first search with SearchLimits::prove, then reused
+
+    public:
+        // Create an engine with a transposition table of about hashMB megabytes
+        Engine(const unsigned int hashMB = HASH_MB_PRESET);
+        ~Engine();
+
+        Engine(const Engine&) = delete;
+        Engine& operator=(const Engine&) = delete;
+
+        // Search position within limits and return the best move found.
+        SearchResult search(const Board& position, const SearchLimits& limits);
+
+        // Forget everything stored in the transposition and proof tables, e.g. before a new game with a different score grid.
+        void clear();
+};
+
+#endif // __ENGINE_H__
\ No newline at end of file
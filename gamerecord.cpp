@@ -0,0 +1,175 @@
+#include <algorithm>
+#include "gamerecord.h"
+
+static const char RECORD_MAGIC[4] = {'P', 'A', '3', 'R'};
+static const unsigned int RECORD_VERSION = 2;
+// Version 1 records have no WIN_LENGTH and were always played with WIN_LENGTH == BOARD_SIZE
+static const unsigned int RECORD_VERSION_FULL_LINES = 1;
+static const size_t RECORD_BUFFER_SIZE = 1 << 16;
+
+// GameRecordWriter constructor
+GameRecordWriter::GameRecordWriter(const std::string& path): file(path, std::ios::binary | std::ios::trunc)
+{
+    buffer.reserve(RECORD_BUFFER_SIZE);
+}
+
+// GameRecordWriter destructor
+GameRecordWriter::~GameRecordWriter()
+{
+    flush();
+}
+
+// GameRecordWriter::put
+//  Append the lowest bytes of value, least significant byte first
+void GameRecordWriter::put(const unsigned long long value, const int bytes)
+{
+    for (int k = 0; k < bytes; ++k) {
+        buffer.push_back(static_cast<char>((value >> (8 * k)) & 0xFF));
+    }
+}
+
+// GameRecordWriter::putMove
+void GameRecordWriter::putMove(const RecordedMove& move)
+{
+    put(move.cell, 1);
+    put(move.depth, 1);
+    put(move.flags, 1);
+    put(move.algorithm, 1);
+    put(static_cast<unsigned int>(move.score), 4);
+    put(move.nodes, 8);
+    put(move.timeUs, 8);
+    if (buffer.size() >= RECORD_BUFFER_SIZE) {
+        flush();
+    }
+}
+
+// GameRecordWriter::beginGame
+void GameRecordWriter::beginGame(const int score[][BOARD_SIZE])
+{
+    buffer.insert(buffer.end(), RECORD_MAGIC, RECORD_MAGIC + 4);
+    put(RECORD_VERSION, 2);
+    put(BOARD_SIZE, 1);
+    put(WIN_LENGTH, 1);
+    for (int i = 0; i < BOARD_SIZE; ++i) {
+        for (int j = 0; j < BOARD_SIZE; ++j) {
+            put(static_cast<unsigned int>(score[i][j]), 4);
+        }
+    }
+}
+
+// GameRecordWriter::addMove
+void GameRecordWriter::addMove(const RecordedMove& move)
+{
+    putMove(move);
+}
+
+// GameRecordWriter::endGame
+void GameRecordWriter::endGame(const int result)
+{
+    RecordedMove end;
+    end.cell = RecordedMove::END_OF_GAME;
+    end.score = result;
+    putMove(end);
+}
+
+// GameRecordWriter::writeGame
+void GameRecordWriter::writeGame(const RecordedGame& game)
+{
+    beginGame(game.score);
+    for (const RecordedMove& move : game.moves) {
+        putMove(move);
+    }
+    if (game.finished) {
+        endGame(game.result);
+    }
+}
+
+// GameRecordWriter::flush
+void GameRecordWriter::flush()
+{
+    if (!buffer.empty() && file.is_open()) {
+        file.write(buffer.data(), buffer.size());
+        file.flush();
+    }
+    buffer.clear();
+}
+
+// GameRecordReader constructor
+GameRecordReader::GameRecordReader(const std::string& path): file(path, std::ios::binary)
+{
+}
+
+// GameRecordReader::get
+//  Read a little endian number of the given size. Return false if the file ends first.
+bool GameRecordReader::get(unsigned long long& value, const int bytes)
+{
+    unsigned char data[8];
+    if (!file.read(reinterpret_cast<char*>(data), bytes)) {
+        return false;
+    }
+    value = 0;
+    for (int k = bytes - 1; k >= 0; --k) {
+        value = (value << 8) | data[k];
+    }
+    return true;
+}
+
+// GameRecordReader::getMove
+bool GameRecordReader::getMove(RecordedMove& move)
+{
+    unsigned long long cell, depth, flags, algorithm, score;
+    if (!get(cell, 1) || !get(depth, 1) || !get(flags, 1) || !get(algorithm, 1) || !get(score, 4)
+        || !get(move.nodes, 8) || !get(move.timeUs, 8)) {
+        return false;
+    }
+    move.cell = static_cast<unsigned char>(cell);
+    move.depth = static_cast<unsigned char>(depth);
+    move.flags = static_cast<unsigned char>(flags);
+    move.algorithm = static_cast<unsigned char>(algorithm);
+    move.score = static_cast<int>(static_cast<unsigned int>(score));
+    return true;
+}
+
+// GameRecordReader::readGame
+//  A game without its end record (e.g. the program was stopped mid-game) is still returned, with the moves read so far.
+bool GameRecordReader::readGame(RecordedGame& game)
+{
+    char magic[4];
+    unsigned long long version, boardSize, winLength;
+    if (!file.read(magic, 4) || !std::equal(magic, magic + 4, RECORD_MAGIC) || !get(version, 2) || !get(boardSize, 1)
+        || boardSize != BOARD_SIZE || !get(winLength, 1)) {
+        return false;
+    }
+    if (version == RECORD_VERSION_FULL_LINES) {
+        winLength = BOARD_SIZE;
+    }
+    else if (version != RECORD_VERSION) {
+        return false;
+    }
+    if (winLength != WIN_LENGTH) {
+        return false;
+    }
+    for (int i = 0; i < BOARD_SIZE; ++i) {
+        for (int j = 0; j < BOARD_SIZE; ++j) {
+            unsigned long long value;
+            if (!get(value, 4)) {
+                return false;
+            }
+            game.score[i][j] = static_cast<int>(static_cast<unsigned int>(value));
+        }
+    }
+
+    game.moves.clear();
+    game.result = 0;
+    game.finished = false;
+    RecordedMove move;
+    while (getMove(move)) {
+        if (move.cell == RecordedMove::END_OF_GAME) {
+            game.result = move.score;
+            game.finished = true;
+            break;
+        }
+        game.moves.push_back(move);
+    }
+    return true;
+}
\ No newline at end of file
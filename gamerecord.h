@@ -0,0 +1,93 @@
+#ifndef __GAMERECORD_H__
+#define __GAMERECORD_H__
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "board.h"
+#include "const.h"
+
+// Binary game records (.pa3r). A file is a sequence of games, and every game is:
+//   header:  "PA3R", version (2 bytes), BOARD_SIZE (1 byte), WIN_LENGTH (1 byte), score grid (4 bytes per cell, row by row)
+//   moves:   one 24-byte record per move, see RecordedMove
+//   end:     a 24-byte record with cell END_OF_GAME whose score is the final board score
+// All numbers are little endian, so records can be read on any machine.
+
+// One move of a game. Moves entered by a player have depth, nodes and timeUs set to 0.
+struct RecordedMove {
+    static constexpr unsigned char END_OF_GAME = 255;
+
+    unsigned char cell {0};         // Cell index (row * BOARD_SIZE + col)
+    unsigned char depth {0};        // Search depth, 0 for MCTS and proof-number search
+    unsigned char flags {0};        // ENGINE and PROVEN below
+    unsigned char algorithm {0};    // SearchLimits::Algorithm of the search
+    int score {0};                  // Estimated score of the move
+    unsigned long long nodes {0};   // Nodes (or MCTS playouts) searched
+    unsigned long long timeUs {0};  // Search time in microseconds
+
+    static constexpr unsigned char ENGINE = 1; // The move was chosen by a search
+    static constexpr unsigned char PROVEN = 2; // The move is a forced win found by the proof-number search
+
+    BoardCoordinate getCoords() const { return BoardCoordinate(cell / BOARD_SIZE, cell % BOARD_SIZE); }
+};
+
+struct RecordedGame {
+    int score[BOARD_SIZE][BOARD_SIZE];
+    std::vector<RecordedMove> moves;
+    int result {0};         // Final board score
+    bool finished {false};  // False if the game has no end record, e.g. it was quit
+};
+
+// Appends games to a record file. Records are collected in a buffer and written in large blocks, so recording does not
+// add a system call per move.
+class GameRecordWriter {
+    private:
+        std::ofstream file;
+        std::vector<char> buffer;
+
+        void put(const unsigned long long value, const int bytes);
+        void putMove(const RecordedMove& move);
+
+    public:
+        // Open (and truncate) the file at path. Check isOpen() afterwards.
+        GameRecordWriter(const std::string& path);
+        // Flush the remaining records
+        ~GameRecordWriter();
+
+        GameRecordWriter(const GameRecordWriter&) = delete;
+        GameRecordWriter& operator=(const GameRecordWriter&) = delete;
+
+        bool isOpen() const { return file.is_open(); }
+
+        // Start a new game played on the given score grid
+        void beginGame(const int score[][BOARD_SIZE]);
+        // Append a move to the current game
+        void addMove(const RecordedMove& move);
+        // Finish the current game with the final board score
+        void endGame(const int result);
+        // Append a whole game, without an end record if it is not finished
+        void writeGame(const RecordedGame& game);
+
+        // Write the buffer to the file
+        void flush();
+};
+
+// Reads the games of a record file one by one.
+class GameRecordReader {
+    private:
+        std::ifstream file;
+
+        bool get(unsigned long long& value, const int bytes);
+        bool getMove(RecordedMove& move);
+
+    public:
+        GameRecordReader(const std::string& path);
+
+        bool isOpen() const { return file.is_open(); }
+
+        // Read the next game into game. Return false at the end of the file or if the data is invalid, e.g. a game
+        // recorded with another BOARD_SIZE or WIN_LENGTH.
+        bool readGame(RecordedGame& game);
+};
+
+#endif // __GAMERECORD_H__
\ No newline at end of file
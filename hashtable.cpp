@@ -1,79 +1,278 @@
+#include <cstring>
+#include <new>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
 #include "hashtable.h"
 #include "const.h"
+#include "profiler.h"
+
+// BoardHashTable::BoardHashTable(const unsigned int sizeMB)
+//  Allocates the table. See resize().
+BoardHashTable::BoardHashTable(const unsigned int sizeMB)
+{
+    resize(sizeMB);
+}
+
+BoardHashTable::~BoardHashTable()
+{
+    release();
+}
+
+// void BoardHashTable::allocate(const unsigned long long bytes)
+//  Every probe of a large table touches a random page, so with 4 KB pages nearly every probe also misses the TLB. Tables
+//  of at least one huge page (2 MB) first try explicit huge pages, which only exist if the administrator reserved them
+//  (vm.nr_hugepages). Otherwise the region is aligned to 2 MB and marked for transparent huge pages, which the kernel
+//  uses when it can. Other tables and other systems use normal pages.
+void BoardHashTable::allocate(const unsigned long long bytes)
+{
+    hugePages = false;
+#ifdef __linux__
+    const unsigned long long HUGE_PAGE = 2ULL << 20;
+    if (bytes >= HUGE_PAGE) {
+        regionBytes = (bytes + HUGE_PAGE - 1) & ~(HUGE_PAGE - 1);
+        region = mmap(nullptr, regionBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (region != MAP_FAILED) {
+            hugePages = true;
+            return;
+        }
+
+        // mmap() only aligns to normal pages, so map one huge page more and unmap what lies outside the aligned region
+        void* mapped = mmap(nullptr, regionBytes + HUGE_PAGE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapped != MAP_FAILED) {
+            const unsigned long long begin = reinterpret_cast<unsigned long long>(mapped);
+            const unsigned long long aligned = (begin + HUGE_PAGE - 1) & ~(HUGE_PAGE - 1);
+            if (aligned > begin) {
+                munmap(mapped, aligned - begin);
+            }
+            munmap(reinterpret_cast<void*>(aligned + regionBytes), begin + HUGE_PAGE - aligned);
+            region = reinterpret_cast<void*>(aligned);
+            hugePages = madvise(region, regionBytes, MADV_HUGEPAGE) == 0;
+            return;
+        }
+    }
+    regionBytes = bytes;
+    region = mmap(nullptr, regionBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED) {
+        region = nullptr;
+        throw std::bad_alloc();
+    }
+#else
+    regionBytes = bytes;
+    region = ::operator new(regionBytes, std::align_val_t(alignof(BoardHashBucket)));
+#endif
+}
+
+// void BoardHashTable::release()
+//  Frees the region of allocate(), if any.
+void BoardHashTable::release()
+{
+    if (region == nullptr) {
+        return;
+    }
+#ifdef __linux__
+    munmap(region, regionBytes);
+#else
+    ::operator delete(region, std::align_val_t(alignof(BoardHashBucket)));
+#endif
+    region = nullptr;
+    regionBytes = 0;
+    buckets = nullptr;
+    bucketCount = 0;
+    forcedWins = nullptr;
+    forcedWinCount = 0;
+}
+
+// void BoardHashTable::resize(const unsigned int sizeMB)
+//  The number of buckets is rounded down to a power of two so that getBucket() does not need a division.
+//  At least one bucket is always allocated. The forced win table gets one entry per 8 entries of the main table, and
+//  both are placed in one region (see allocate()). If the allocation fails, the table is left empty and bad_alloc is
+//  thrown.
+void BoardHashTable::resize(const unsigned int sizeMB)
+{
+    const unsigned long long bytes = static_cast<unsigned long long>(sizeMB) << 20;
+    unsigned long long count = 1;
+    while (count * 2 * sizeof(BoardHashBucket) <= bytes) {
+        count *= 2;
+    }
+
+    const unsigned long long forcedWinEntries = (count * BUCKET_SIZE + 7) / 8;
+    release();
+    allocate(count * sizeof(BoardHashBucket) + forcedWinEntries * sizeof(ForcedWinEntry));
+    bucketCount = count;
+    forcedWinCount = forcedWinEntries;
+    buckets = static_cast<BoardHashBucket*>(region);
+    forcedWins = reinterpret_cast<ForcedWinEntry*>(buckets + bucketCount);
+    clearTable();
+}
+
+// BoardHashTable::BoardHashEntry* BoardHashTable::findEntry(const unsigned long long id)
+//  An entry that is found is used by the current search, so it is marked with the current generation.
+BoardHashTable::BoardHashEntry* BoardHashTable::findEntry(const unsigned long long id)
+{
+    BoardHashBucket& bucket = getBucket(id);
+    for (int k = 0; k < BUCKET_SIZE; ++k) {
+        if (bucket.entries[k].generation != 0 && bucket.entries[k].id == id) {
+            bucket.entries[k].generation = generation;
+            return &bucket.entries[k];
+        }
+    }
+    return nullptr;
+}
+
+// int BoardHashTable::getAge(const BoardHashEntry& entry) const
+//  Returns 2 for an empty entry, 1 for an entry of an older search and 0 for an entry of the current search.
+int BoardHashTable::getAge(const BoardHashEntry& entry) const
+{
+    if (entry.generation == 0) return 2;
+    return entry.generation != generation ? 1 : 0;
+}
+
+BoardOptimalMove BoardHashTable::toOptimalMove(const BoardHashEntry& entry) const
+{
+    if (entry.cell == NO_CELL) {
+        return BoardOptimalMove(entry.score, BoardCoordinate(-1, -1));
+    }
+    return BoardOptimalMove(entry.score, BoardCoordinate(entry.cell / BOARD_SIZE, entry.cell % BOARD_SIZE));
+}
 
 // BoardOptimalMove BoardHashTable::getHashedMove(const unsigned long long id, const int depth)
 //  Returns the BoardOptimalMove stored in the hash table for the given board ID and search depth.
 //  If the board ID does not exist in the table, or the ID is stored but the search depth is lower than the parameter, then return an illegal move indicating that the table does not contain the queried board ID or the stored calculation is not sufficient (if the search depth parameter is equal to or lower than the stored search depth, return the stored move).
 BoardOptimalMove BoardHashTable::getHashedMove(const unsigned long long id, const int depth)
 {
-    // Get the head of the linked list at the index of the table
-    BoardHashNode* head = table[id % TABLE_SIZE];
-    // Traverse the linked list
-    while (head != nullptr) {
-        // If the board ID is found
-        if (head->id == id) {
-            // If the stored depth is lower than the parameter
-            if (head->depth < depth) {
-                // Return an illegal move
-                return BoardOptimalMove();
-            }
-            // Else, return the stored move
-            return head->optimalMove;
-        }
-        // Move to the next node
-        head = head->next;
+    PROFILE_SCOPE(PROFILE_PROBE);
+    const BoardHashEntry* entry = findEntry(id);
+    // If the board ID is not found, the stored depth is lower than the parameter, or only a bound is stored
+    if (entry == nullptr || entry->depth < depth || entry->bound != EXACT) {
+        // Return an illegal move
+        return BoardOptimalMove();
+    }
+    // Else, return the stored move
+    return toOptimalMove(*entry);
+}
+
+// BoardOptimalMove BoardHashTable::getHashedMove(const unsigned long long id, const int depth, const int alpha, const int beta)
+//  Like getHashedMove(id, depth), but a lower bound at or above beta (or an upper bound at or below alpha) is returned
+//  as well, since it is all alpha-beta needs to cut off the node.
+BoardOptimalMove BoardHashTable::getHashedMove(const unsigned long long id, const int depth, const int alpha, const int beta)
+{
+    PROFILE_SCOPE(PROFILE_PROBE);
+    const BoardHashEntry* entry = findEntry(id);
+    if (entry == nullptr || entry->depth < depth) {
+        return BoardOptimalMove();
+    }
+    if (entry->bound == EXACT
+        || (entry->bound == LOWER && entry->score >= beta)
+        || (entry->bound == UPPER && entry->score <= alpha)) {
+        return toOptimalMove(*entry);
     }
-    // If the board ID is not found, return an illegal move
     return BoardOptimalMove();
 }
 
-// void BoardHashTable::updateTable(const unsigned long long id, const int depth, const BoardOptimalMove &optimalMove)
+// BoardCoordinate BoardHashTable::getHashedCoords(const unsigned long long id)
+//  Returns the move stored for the board ID regardless of depth and bound. A move that was best (or caused a cutoff) at
+//  some depth is a good first guess at any other depth.
+BoardCoordinate BoardHashTable::getHashedCoords(const unsigned long long id)
+{
+    PROFILE_SCOPE(PROFILE_PROBE);
+    const BoardHashEntry* entry = findEntry(id);
+    if (entry == nullptr) {
+        return BoardCoordinate(-1, -1);
+    }
+    return toOptimalMove(*entry).coords;
+}
+
+// void BoardHashTable::updateTable(const unsigned long long id, const int depth, const BoardOptimalMove &optimalMove, const BoardHashBound bound)
 //  Updates the table with the optimal move for the given board ID and search depth.
-//  If the board ID does not exist in the table, create a new node at the corresponding linked list (the node can be inserted anywhere in the list).
-//  Otherwise, if the stored depth of the board ID is lower than the depth parameter, update the node's depth and optimalMove.
-void BoardHashTable::updateTable(const unsigned long long id, const int depth, const BoardOptimalMove& optimalMove)
-{
-    // Get the head of the linked list at the index of the table
-    BoardHashNode* head = table[id % TABLE_SIZE];
-    // Traverse the linked list
-    while (head != nullptr) {
-        // If the board ID is found
-        if (head->id == id) {
-            // If the stored depth is lower than the parameter
-            if (head->depth < depth) {
-                // Update the depth and optimal move
-                head->depth = depth;
-                head->optimalMove = optimalMove;
+//  If the board ID exists in the table and the stored depth is lower than the depth parameter, update the entry's depth and optimalMove.
+//  An exact score also replaces a bound of the same depth.
+//  Otherwise the new entry takes the place of an empty entry if the bucket has one. Failing that, entries of older searches
+//  are replaced before entries of the current one, and among those the shallowest, which is the cheapest to recompute.
+void BoardHashTable::updateTable(const unsigned long long id, const int depth, const BoardOptimalMove& optimalMove, const BoardHashBound bound)
+{
+    PROFILE_SCOPE(PROFILE_STORE);
+    BoardHashBucket& bucket = getBucket(id);
+    BoardHashEntry* victim = nullptr;
+    for (int k = 0; k < BUCKET_SIZE; ++k) {
+        BoardHashEntry& entry = bucket.entries[k];
+        if (entry.generation != 0 && entry.id == id) {
+            entry.generation = generation;
+            if (entry.depth > depth || (entry.depth == depth && (entry.bound == EXACT || bound != EXACT))) {
+                return;
             }
-            // Return
-            return;
+            victim = &entry;
+            break;
+        }
+        if (victim == nullptr || getAge(entry) > getAge(*victim) || (getAge(entry) == getAge(*victim) && entry.depth < victim->depth)) {
+            victim = &entry;
         }
-        // Move to the next node
-        head = head->next;
     }
-    // If the board ID is not found, create a new node at the head of the linked list
-    head = new BoardHashNode(id, depth, optimalMove);
-    head->next = table[id % TABLE_SIZE];
-    table[id % TABLE_SIZE] = head;
+
+    victim->id = id;
+    victim->score = optimalMove.score;
+    victim->cell = optimalMove.coords.isValid() ? static_cast<unsigned char>(optimalMove.coords.row * BOARD_SIZE + optimalMove.coords.col) : NO_CELL;
+    victim->depth = static_cast<unsigned char>(depth < 0 ? 0 : (depth > 255 ? 255 : depth));
+    victim->bound = static_cast<unsigned char>(bound);
+    victim->generation = generation;
 }
 
-// void BoardHashTable::clearTable()
-//  Free all dynamic memories in the hash table and reset the linked lists to nullptr.
-void BoardHashTable::clearTable(){
-// Traverse the table
-    for (int i = 0; i < TABLE_SIZE; i++) {
-        // Get the head of the linked list
-        BoardHashNode* head = table[i];
-        // Traverse the linked list
-        while (head != nullptr) {
-            // Store the next node
-            BoardHashNode* next = head->next;
-            // Delete the current node
-            delete head;
-            // Move to the next node
-            head = next;
-        }
-        // Reset the linked list to nullptr
-        table[i] = nullptr;
+// BoardOptimalMove BoardHashTable::getForcedWin(const unsigned long long id, bool& exact) const
+//  The forced win table is direct-mapped: each board ID has exactly one slot.
+BoardOptimalMove BoardHashTable::getForcedWin(const unsigned long long id, bool& exact) const
+{
+    PROFILE_SCOPE(PROFILE_PROBE);
+    const ForcedWinEntry& entry = forcedWins[id % forcedWinCount];
+    if (entry.winner == EMPTY || entry.id != id) {
+        return BoardOptimalMove();
     }
+    exact = entry.exact;
+    return BoardOptimalMove(getWinScore(static_cast<Cell>(entry.winner), entry.distance), BoardCoordinate(entry.cell / BOARD_SIZE, entry.cell % BOARD_SIZE));
+}
+
+// BoardOptimalMove BoardHashTable::getForcedWin(const unsigned long long id) const
+//  Searches that need the fastest win cannot use an upper bound of its distance, so they only get exact entries.
+BoardOptimalMove BoardHashTable::getForcedWin(const unsigned long long id) const
+{
+    bool exact = false;
+    const BoardOptimalMove forcedWin = getForcedWin(id, exact);
+    return exact ? forcedWin : BoardOptimalMove();
 }
+
+// void BoardHashTable::storeForcedWin(const unsigned long long id, const BoardOptimalMove& optimalMove, const bool exact)
+//  Overwrites the slot unless it holds the exact distance, or a bound at least as fast for the same board. Forced wins
+//  are rare and cheap to prove again, so there is no other replacement policy.
+void BoardHashTable::storeForcedWin(const unsigned long long id, const BoardOptimalMove& optimalMove, const bool exact)
+{
+    PROFILE_SCOPE(PROFILE_STORE);
+    if (!optimalMove.coords.isValid()) {
+        return;
+    }
+    ForcedWinEntry& entry = forcedWins[id % forcedWinCount];
+    const int distance = getWinDistance(optimalMove.score);
+    if (entry.winner != EMPTY && entry.id == id && (entry.exact || (!exact && entry.distance <= distance))) {
+        return;
+    }
+    entry.id = id;
+    entry.distance = static_cast<unsigned char>(distance);
+    entry.exact = exact;
+    entry.cell = static_cast<unsigned char>(optimalMove.coords.row * BOARD_SIZE + optimalMove.coords.col);
+    entry.winner = static_cast<signed char>(optimalMove.score > 0 ? X : O);
+}
+
+// void BoardHashTable::newSearch()
+//  Generation 0 marks empty entries, so it is skipped when the counter wraps around.
+void BoardHashTable::newSearch()
+{
+    if (++generation == 0) {
+        generation = 1;
+    }
+}
+
+// void BoardHashTable::clearTable()
+//  Mark every entry of both tables as empty.
+void BoardHashTable::clearTable()
+{
+    memset(static_cast<void*>(buckets), 0, bucketCount * sizeof(BoardHashBucket));
+    memset(static_cast<void*>(forcedWins), 0, forcedWinCount * sizeof(ForcedWinEntry));
+}
\ No newline at end of file
@@ -4,44 +4,141 @@
 #include "board.h"
 #include "const.h"
 
+// Meaning of a stored score. Minimax always stores exact scores, while alpha-beta only knows a bound when the true score
+// falls outside of its window.
+enum BoardHashBound {
+    EXACT, // The stored score is the true score
+    LOWER, // The true score is at least the stored score (alpha-beta cutoff)
+    UPPER, // The true score is at most the stored score (no move reached alpha)
+};
+
 class BoardHashTable {
     private:
-        struct BoardHashNode {
+        // 16 bytes per entry, so that a bucket fills exactly one 64-byte cache line
+        struct BoardHashEntry {
             unsigned long long id;
-            int depth;
-            BoardOptimalMove optimalMove;
-            BoardHashNode* next;
+            int score;
+            unsigned char cell;       // Cell index (row * BOARD_SIZE + col) of the stored move, NO_CELL for none
+            unsigned char depth;
+            unsigned char bound;      // BoardHashBound
+            unsigned char generation; // Search in which the entry was last stored or found, 0 for an empty entry
+        };
+
+        static constexpr int BUCKET_SIZE = 4;
+        static constexpr unsigned char NO_CELL = 255;
 
-            BoardHashNode(const unsigned long long id, const int depth, const BoardOptimalMove& optimalMove): 
-                id(id), depth(depth), optimalMove(optimalMove), next(nullptr) {}
+        struct alignas(64) BoardHashBucket {
+            BoardHashEntry entries[BUCKET_SIZE];
+        };
+
+        // Forced matches do not depend on the score grid, so they are kept in a separate, smaller table keyed by the
+        // plain board ID, where every grid can use them.
+        struct ForcedWinEntry {
+            unsigned long long id;
+            unsigned char cell;     // Winning move
+            signed char winner;     // X or O, EMPTY for an empty entry
+            unsigned char distance; // Plies until the match, see getWinScore()
+            bool exact;             // distance is the fastest match, otherwise only an upper bound of it
         };
 
-        BoardHashNode* table[TABLE_SIZE] {nullptr};
+        // Both tables share one contiguous region: the buckets, followed by the forced wins
+        void* region {nullptr};
+        unsigned long long regionBytes {0};
+        bool hugePages {false};    // region is backed by (or eligible for transparent) huge pages
+        BoardHashBucket* buckets {nullptr};
+        unsigned long long bucketCount {0};
+        ForcedWinEntry* forcedWins {nullptr};
+        unsigned long long forcedWinCount {0};
+        unsigned char generation {1};
+
+        // Allocate region with at least bytes bytes, on huge pages if possible. Free it with release().
+        void allocate(const unsigned long long bytes);
+        void release();
+
+        // Return the bucket in which key is stored. Keys of small boards are base-3 board IDs mixed with the score grid
+        // (see Board::getHashKey()), so their low bits are poorly distributed. Multiplying by an odd constant mixes all
+        // bits into the high bits, which then select the bucket.
+        BoardHashBucket& getBucket(const unsigned long long key) const
+        {
+            return buckets[(key * 0x9E3779B97F4A7C15ULL) >> 32 & (bucketCount - 1)];
+        }
+
+        // Return the entry stored for id, or nullptr if there is none
+        BoardHashEntry* findEntry(const unsigned long long id);
+
+        // Replacement priority of an entry, higher is replaced first
+        int getAge(const BoardHashEntry& entry) const;
 
-        BoardHashTable() = default;
-        ~BoardHashTable() { clearTable(); }
+        // Convert an entry back to a BoardOptimalMove
+        BoardOptimalMove toOptimalMove(const BoardHashEntry& entry) const;
     
     public:
+        // Create a table using about sizeMB megabytes. Engines that need their own table (see engine.h) create one,
+        // everything else shares getInstance().
+        BoardHashTable(const unsigned int sizeMB = HASH_MB_PRESET);
+        ~BoardHashTable();
+
         BoardHashTable(const BoardHashTable&) = delete;
         BoardHashTable& operator=(const BoardHashTable&) = delete;
         
-        // Return the only instance of BoardHashTable
+        // Return the shared instance of BoardHashTable
         static BoardHashTable& getInstance()
         {
             static BoardHashTable instance;
             return instance;
         }
         
+        // The ids of the functions below are transposition table keys, i.e. Board::getHashKey(), except for the forced wins.
+
         // Return the stored BoardOptimalMove for the given id and depth. If it is not stored, return "illegal" (default) BoardOptimalMove.
+        // Only exact scores are returned.
         BoardOptimalMove getHashedMove(const unsigned long long id, const int depth);
 
+        // Same as above, but also return a bound if it is enough to decide the result of the window [alpha, beta].
+        BoardOptimalMove getHashedMove(const unsigned long long id, const int depth, const int alpha, const int beta);
+
+        // Return the stored move for the given id at any depth, or (-1, -1) if id is not stored. Used for move ordering.
+        BoardCoordinate getHashedCoords(const unsigned long long id);
+
         // Update the table with the optimal move for the given id and depth.
-        // If id does not exist, create a new linked list node at (id % TABLE_SIZE).
-        // Else, if stored depth is lower, update the optimal move with the parameter. Otherwise, do nothing.
-        void updateTable(const unsigned long long id, const int depth, const BoardOptimalMove& optimalMove);
+        // If id is stored, and the stored depth is lower, or equal with a stored bound and a new exact score, update the optimal move with the parameter.
+        // If id is not stored, it replaces an empty entry, else the shallowest entry of an older search, else the shallowest entry in its bucket.
+        void updateTable(const unsigned long long id, const int depth, const BoardOptimalMove& optimalMove, const BoardHashBound bound = EXACT);
 
-        // Clear all dynamic memory and reset table array to all nullptr.
+        // Return the winning move stored for the board ID, whose score is a win score (see getWinScore()) for the winner,
+        // or an illegal move if no forced match is known. Independent of the score grid and of the search depth.
+        // exact is set to false if the distance of the stored win is only an upper bound, i.e. the winner may win faster
+        // and the true score is at least as good for them. The overload without it only returns exact distances.
+        BoardOptimalMove getForcedWin(const unsigned long long id, bool& exact) const;
+        BoardOptimalMove getForcedWin(const unsigned long long id) const;
+
+        // Store a forced match for the board ID. optimalMove is the winning move with its win score, and exact tells if its
+        // distance is the fastest match. Some callers only know an upper bound of the distance (e.g. the proof-number
+        // search), so an exact entry, or an entry with a shorter distance, is kept.
+        void storeForcedWin(const unsigned long long id, const BoardOptimalMove& optimalMove, const bool exact);
+
+        // Start loading the entries of a position into the cache, so that probing it later does not stall. key is the
+        // transposition table key and id the board ID (for the forced wins), e.g. from Board::getChildHashKey().
+        void prefetch(const unsigned long long key, const unsigned long long id) const
+        {
+            __builtin_prefetch(&getBucket(key));
+            __builtin_prefetch(&forcedWins[id % forcedWinCount]);
+        }
+
+        // Start a new search. Entries that are not stored or found again from now on are replaced first.
+        void newSearch();
+
+        // Drop all entries and reallocate the table with about sizeMB megabytes.
+        void resize(const unsigned int sizeMB);
+
+        // Remove all entries.
         void clearTable();
+
+        // Size of the table in bytes
+        unsigned long long getSize() const { return bucketCount * sizeof(BoardHashBucket) + forcedWinCount * sizeof(ForcedWinEntry); }
+
+        // Return true if the table is backed by huge pages, which save most of the TLB misses of probing a large table
+        bool usesHugePages() const { return hugePages; }
 };
 
 #endif // __HASHTABLE_H__
\ No newline at end of file
@@ -2,18 +2,42 @@
 using namespace std;
 
 #include <chrono>
+#include <cstdlib>
 
 #include "board.h"
 #include "boardtree.h"
+#include "engine.h"
+#include "gamerecord.h"
 #include "hashtable.h"
+#include "mcts.h"
+#include "profiler.h"
+#include "proofsearch.h"
 
 int main(int argc, char* argv[]) {
+    // cout is only used from this thread, so it does not have to stay in sync with stdio after every output. Together
+    // with '\n' instead of endl in the game loop, output is written in blocks instead of line by line. Reading from cin
+    // still flushes cout first, so prompts are shown in the interactive modes.
+    ios::sync_with_stdio(false);
+
     // Parameters
     bool scoreInput = false;
     enum {AUTO, VERSUS, HINTED, MANUAL} mode = HINTED;
     bool alphabeta = false;
+    bool aspiration = false;
     int score[BOARD_SIZE][BOARD_SIZE];
     int searchDepth = -1;
+    bool mcts = false;
+    MCTSLimits mctsLimits;
+    bool prove = false;
+    bool backgroundFree = false;
+    bool fastExit = false;
+    string recordPath;
+#ifdef PA3_PROFILE
+    bool profile = false;
+    string tracePath;
+#endif
+    // TEXT prints every board, QUIET only the result, JSON one line per move and one for the result
+    enum {TEXT, QUIET, JSON} format = TEXT;
 
     for (int i=1; i<argc; i++) {
         // If manual scoreboard input is enabled
@@ -53,6 +77,128 @@ int main(int argc, char* argv[]) {
             alphabeta = true;
         }
 
+        // If aspiration windows are enabled (implies alpha-beta pruning)
+        else if (string(argv[i]) == "-asp" || string(argv[i]) == "--aspiration") {
+            alphabeta = true;
+            aspiration = true;
+        }
+
+        // If the threat extension is enabled
+        else if (string(argv[i]) == "-x" || string(argv[i]) == "--extend") {
+            SearchOptions::getInstance().threatExtension = true;
+        }
+
+        // If late move reductions are enabled (alpha-beta only)
+        else if (string(argv[i]) == "-lmr" || string(argv[i]) == "--reductions") {
+            SearchOptions::getInstance().lateMoveReductions = true;
+        }
+
+        // If futility pruning is enabled (alpha-beta only)
+        else if (string(argv[i]) == "-fp" || string(argv[i]) == "--futility") {
+            SearchOptions::getInstance().futilityPruning = true;
+        }
+
+        // If the MCTS engine is enabled
+        else if (string(argv[i]) == "-mc" || string(argv[i]) == "--mcts") {
+            mcts = true;
+        }
+
+        // If the forced win precheck is enabled
+        else if (string(argv[i]) == "-p" || string(argv[i]) == "--prove") {
+            prove = true;
+        }
+
+        // MCTS budget specification
+        else if (string(argv[i]) == "-i" || string(argv[i]) == "--iterations" || string(argv[i]) == "-t" || string(argv[i]) == "--threads" || string(argv[i]) == "--time") {
+            if (i == argc - 1) {
+                cout << "Invalid command line argument. Type .\\pa3.exe -h or .\\pa3.exe --help for details." << endl;
+                return 0;
+            }
+            string option = argv[i];
+            unsigned int value = atoi(argv[++i]);
+            if (option == "-i" || option == "--iterations") mctsLimits.iterations = value;
+            else if (option == "-t" || option == "--threads") mctsLimits.threads = value;
+            else mctsLimits.timeLimitMs = value;
+        }
+
+        // Transposition table size specification
+        else if (string(argv[i]) == "--hash-mb") {
+            if (i == argc - 1) {
+                cout << "Invalid command line argument. Type .\\pa3.exe -h or .\\pa3.exe --help for details." << endl;
+                return 0;
+            }
+            BoardHashTable::getInstance().resize(atoi(argv[++i]));
+        }
+
+        // If discarded subtrees should be freed on a background thread
+        else if (string(argv[i]) == "-bg" || string(argv[i]) == "--background-free") {
+            backgroundFree = true;
+        }
+
+        // If the search tree should not be freed at exit
+        else if (string(argv[i]) == "--fast-exit") {
+            fastExit = true;
+        }
+
+        // Output format specification
+        else if (string(argv[i]) == "-q" || string(argv[i]) == "--quiet" || string(argv[i]) == "--format=quiet") {
+            format = QUIET;
+        }
+        else if (string(argv[i]) == "--format=json") {
+            format = JSON;
+        }
+        else if (string(argv[i]) == "--format=text") {
+            format = TEXT;
+        }
+
+        // Game record file specification
+        else if (string(argv[i]) == "--record") {
+            if (i == argc - 1) {
+                cout << "Invalid command line argument. Type .\\pa3.exe -h or .\\pa3.exe --help for details." << endl;
+                return 0;
+            }
+            recordPath = argv[++i];
+        }
+
+        // Phase profiler options, only available in builds with the profiler (make profile)
+        else if (string(argv[i]) == "--profile" || string(argv[i]) == "--profile-trace") {
+#ifdef PA3_PROFILE
+            if (string(argv[i]) == "--profile") {
+                profile = true;
+            }
+            else {
+                if (i == argc - 1) {
+                    cout << "Invalid command line argument. Type .\\pa3.exe -h or .\\pa3.exe --help for details." << endl;
+                    return 0;
+                }
+                tracePath = argv[++i];
+                PhaseProfile::getInstance().setTracing(true);
+            }
+#else
+            cout << "This build has no phase profiler. Build it with make profile." << endl;
+            return 0;
+#endif
+        }
+
+        // Search tree memory cap specification
+        else if (string(argv[i]) == "--tree-mb") {
+            if (i == argc - 1) {
+                cout << "Invalid command line argument. Type .\\pa3.exe -h or .\\pa3.exe --help for details." << endl;
+                return 0;
+            }
+            SearchOptions::getInstance().treeMB = atoi(argv[++i]);
+        }
+
+        // Candidate move radius specification
+        else if (string(argv[i]) == "-r" || string(argv[i]) == "--radius") {
+            if (i == argc - 1) {
+                cout << "Invalid command line argument. Type .\\pa3.exe -h or .\\pa3.exe --help for details." << endl;
+                return 0;
+            }
+            SearchOptions::getInstance().candidateRadius = atoi(argv[++i]);
+            mctsLimits.candidateRadius = SearchOptions::getInstance().candidateRadius;
+        }
+
         // Depth specification
         else if (string(argv[i]) == "-d" || string(argv[i]) == "--depth") {
             if (i == argc - 1) {
@@ -66,8 +212,27 @@ int main(int argc, char* argv[]) {
         else if (string(argv[i]) == "-h" || string(argv[i]) == "--help") {
             cout << "The following arguments are available:" << endl;
             cout << "-d [num] or --depth [num]: \t\t Set the search depth. Default value is specified in const.h." << endl;
+            cout << "--hash-mb [num]: \t\t\t Set the transposition table size in megabytes. Default value is specified in const.h." << endl;
+            cout << "--tree-mb [num]: \t\t\t Cap the search tree memory in megabytes, collapsing the least recently used subtrees. Allows any depth." << endl;
+            cout << "-r [num] or --radius [num]: \t\t Only search empty cells within num rows and columns of a stone (0 for all). Default value is specified in const.h." << endl;
             cout << "-s or --score: \t\t\t Enable manual score grid input. Default values are specified in const.h." << endl;
             cout << "-ab or --alphabeta: \t\t\t Enable alpha-beta pruning." << endl;
+            cout << "-asp or --aspiration: \t\t Enable iterative deepening alpha-beta with aspiration windows." << endl;
+            cout << "-x or --extend: \t\t\t Keep searching moves that complete or block a match beyond the search depth." << endl;
+            cout << "-lmr or --reductions: \t\t Search late alpha-beta moves one ply less deep unless they look better than the best move." << endl;
+            cout << "-fp or --futility: \t\t\t Skip alpha-beta moves near the leaves that cannot reach the window. Ignored with -x." << endl;
+            cout << "-mc or --mcts: \t\t\t Use the Monte Carlo Tree Search engine instead of BoardTree." << endl;
+            cout << "-p or --prove: \t\t\t Check for a forced win with proof-number search before each engine move." << endl;
+            cout << "-bg or --background-free: \t\t Free the subtrees of the moves not played on a background thread." << endl;
+            cout << "--fast-exit: \t\t\t Exit without freeing the search tree." << endl;
+            cout << "--record [file]: \t\t\t Write the game to a binary record file, see pa3_replay.exe." << endl;
+            cout << "--profile: \t\t\t Print the time spent in each phase of every BoardTree search (make profile builds only)." << endl;
+            cout << "--profile-trace [file]: \t\t Write the phases of all BoardTree searches to a Chrome trace file (make profile builds only)." << endl;
+            cout << "-q or --quiet: \t\t\t Only print the result of the game (same as --format=quiet)." << endl;
+            cout << "--format=json: \t\t\t Print one JSON object per move and one for the result instead of the boards. Prompts go to stderr." << endl;
+            cout << "-i [num] or --iterations [num]: \t Set the MCTS playout budget (0 for no limit). Default value is specified in const.h." << endl;
+            cout << "--time [ms]: \t\t\t Set the MCTS time budget in milliseconds (0 for no limit)." << endl;
+            cout << "-t [num] or --threads [num]: \t\t Set the number of MCTS search threads." << endl;
             cout << "-a or --auto: \t\t\t Let BoardTree automatically plays its suggested moves." << endl;
             cout << "-v or --versus: \t\t\t Play against the BoardTree." << endl;
             cout << "-m or --manual: \t\t\t Disable BoardTree if you would like to test the game logic." << endl;
@@ -81,19 +246,24 @@ int main(int argc, char* argv[]) {
             return 0;
         }
     }
-    
+
+    // The interactive prompts are not part of the JSON output, which has one object per line, so they go to stderr
+    ostream& prompt = (format == JSON) ? cerr : cout;
+
     if (searchDepth <= 0) {
-        cout << "Search depth not specified. Using preset depth of " << DEPTH_PRESET << "." << endl;
+        if (format == TEXT)
+            cout << "Search depth not specified. Using preset depth of " << DEPTH_PRESET << "." << endl;
         searchDepth = DEPTH_PRESET;
     }
 
-    if (pow(BOARD_SIZE * BOARD_SIZE, searchDepth) > 1e10) {
+    // MCTS does not build a full-width tree, and a capped tree cannot run out of memory, so the depth limit does not apply to them
+    if (!mcts && SearchOptions::getInstance().treeMB == 0 && pow(BOARD_SIZE * BOARD_SIZE, searchDepth) > 1e10) {
         cout << "WARNING: High search depth can use up a large amount of memory and will likely crash your computer. Aborting." << endl;
         return 0;
     }
 
     if (scoreInput) {
-        cout << "Input the score for each cell, row by row: " << endl;
+        prompt << "Input the score for each cell, row by row: " << endl;
         for (int j=0; j<BOARD_SIZE; ++j) {
             for (int k=0; k<BOARD_SIZE; ++k) {
                 cin >> score[j][k];
@@ -111,100 +281,277 @@ int main(int argc, char* argv[]) {
     int player = -1;
     if (mode == VERSUS) {
         do {
-            cout << "Which player you would like to play as (0 for O, 1 for X)? Type -1 to quit game." << endl;
+            prompt << "Which player you would like to play as (0 for O, 1 for X)? Type -1 to quit game." << endl;
             cin >> player;
         } while (player < -1 || player >= 2);
         if (player == -1) return 0;
     }
 
-    cout << "Score grid:" << endl;
-    printBoard<int, int>(cout, score, [](int x)->int {return x;});
-    
-    cout << "Search depth: " << searchDepth << endl;
-    
     Board board{score};
-    cout << board;
-    cout << "Score: " << board.getBoardScore() << endl;
-    cout << "ID: " << board.getID() << endl;
+    if (format == TEXT) {
+        cout << "Score grid:" << endl;
+        printBoard<int, int>(cout, score, [](int x)->int {return x;});
+
+        if (mcts)
+            cout << "MCTS iterations: " << mctsLimits.iterations << ", time limit: " << mctsLimits.timeLimitMs << " ms, threads: " << mctsLimits.threads << endl;
+        else {
+            cout << "Search depth: " << searchDepth << endl;
+            const BoardHashTable& table = BoardHashTable::getInstance();
+            cout << "Transposition table: " << (table.getSize() >> 20) << " MB on " << (table.usesHugePages() ? "huge" : "normal") << " pages" << endl;
+        }
+
+        cout << board;
+        cout << "Score: " << board.getBoardScore() << endl;
+        cout << "ID: " << board.getID() << endl;
+    }
 
     BoardTree tree{board};
     BoardTree* currentTreeRoot = &tree;
+    MCTSEngine mctsEngine{mctsLimits};
+    ProofNumberSearch prover;
+    int lastScore = 0;
+
+    GameRecordWriter* recordWriter = nullptr;
+    if (!recordPath.empty()) {
+        recordWriter = new GameRecordWriter(recordPath);
+        if (!recordWriter->isOpen()) {
+            cout << "Cannot open " << recordPath << " for writing." << endl;
+            delete recordWriter;
+            return 0;
+        }
+        recordWriter->beginGame(score);
+    }
+    // Statistics of the last search, written to the record with the move
+    RecordedMove lastSearch;
+
+    // Ask the selected engine for the best move of the current board. If analysis is given, a BoardTree search also fills
+    // it with the scores of all moves (it is left untouched by MCTS and proven wins).
+    auto searchMove = [&](BoardSearchResult* analysis = nullptr) -> BoardOptimalMove {
+        chrono::steady_clock::time_point searchBegin = chrono::steady_clock::now();
+        lastSearch = RecordedMove();
+        lastSearch.flags = RecordedMove::ENGINE;
+        lastSearch.algorithm = mcts ? SearchLimits::MCTS : aspiration ? SearchLimits::ASPIRATION : alphabeta ? SearchLimits::ALPHABETA : SearchLimits::MINIMAX;
+        lastSearch.depth = mcts ? 0 : searchDepth;
+        auto finish = [&](const BoardOptimalMove& optMove, const unsigned long long nodes) -> BoardOptimalMove {
+            lastSearch.score = optMove.score;
+            lastSearch.nodes += nodes;
+            lastSearch.timeUs = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - searchBegin).count();
+            return optMove;
+        };
+
+        if (prove) {
+            ProofOutcome outcome = prover.prove(board, board.getCurPlayer());
+            lastSearch.nodes = outcome.nodes;
+            if (outcome.result == PROVEN && outcome.move.isValid()) {
+                if (format == TEXT)
+                    cout << "Forced win for " << cell2chr(board.getCurPlayer()) << " found in " << outcome.nodes << " nodes." << '\n';
+                lastSearch.flags |= RecordedMove::PROVEN;
+                lastSearch.depth = 0;
+                return finish(BoardOptimalMove(outcome.score, outcome.move), 0);
+            }
+        }
+        if (mcts) {
+            BoardOptimalMove optMove = mctsEngine.getOptimalMove(board);
+            return finish(optMove, mctsEngine.getIterations());
+        }
+
+        SearchStats& stats = SearchStats::getInstance();
+        stats.reset();
+        BoardHashTable::getInstance().newSearch();
+        BoardOptimalMove optMove;
+#ifdef PA3_PROFILE
+        PhaseProfile::getInstance().reset();
+#endif
+        {
+            PROFILE_SCOPE(PROFILE_SEARCH);
+            if (analysis) {
+                *analysis = currentTreeRoot->getSearchResult(searchDepth, alphabeta);
+                optMove = analysis->best;
+            }
+            else if (aspiration)
+                optMove = currentTreeRoot->getOptimalMoveAspiration(searchDepth, lastScore);
+            else if (alphabeta)
+                optMove = currentTreeRoot->getOptimalMoveAlphaBeta(searchDepth, -WIN_SCORE - 1, WIN_SCORE + 1);
+            else
+                optMove = currentTreeRoot->getOptimalMove(searchDepth);
+        }
+        lastScore = optMove.score;
+        if (format == TEXT) {
+            cout << "Nodes searched: " << stats.nodes << '\n';
+            if (aspiration)
+                cout << "Aspiration re-searches: " << stats.reSearches << '\n';
+            if (stats.evictions > 0)
+                cout << "Subtrees collapsed: " << stats.evictions << '\n';
+            if (stats.reductions > 0)
+                cout << "Reduced searches: " << stats.reductions << " (" << stats.verifications << " verified at full depth)" << '\n';
+            if (stats.futilityPrunes > 0)
+                cout << "Futility prunes: " << stats.futilityPrunes << '\n';
+        }
+#ifdef PA3_PROFILE
+        if (profile && format == TEXT)
+            PhaseProfile::getInstance().printReport(cout);
+#endif
+        return finish(optMove, stats.nodes);
+    };
+
+    // Result of the game, nullptr if the game was quit
+    const char* result = nullptr;
+    int plies = 0;
 
     chrono::steady_clock::time_point begin = chrono::steady_clock::now();
     while (true) {
         BoardCoordinate move{-1, -1};
+        bool engineMove = false;
         if (mode == AUTO || mode == VERSUS && ((player == 0 && board.getCurPlayer() == X) || (player == 1 && board.getCurPlayer() == O))) {
             // Bot
-            BoardOptimalMove optMove;
-            if (alphabeta)
-                optMove = currentTreeRoot->getOptimalMoveAlphaBeta(searchDepth, -WIN_SCORE - 1, WIN_SCORE + 1);
-            else
-                optMove = currentTreeRoot->getOptimalMove(searchDepth);
-            cout << "Estimated best score: " << optMove.score << endl;
-            cout << "Row: " << optMove.coords.row << endl;
-            cout << "Col: " << optMove.coords.col << endl;
+            BoardOptimalMove optMove = searchMove();
+            if (format == TEXT) {
+                cout << "Estimated best score: " << optMove.score << '\n';
+                cout << "Row: " << optMove.coords.row << '\n';
+                cout << "Col: " << optMove.coords.col << '\n';
+            }
             move = optMove.coords;
+            engineMove = true;
         }
         else {
             // Give hint in non-versus
             if (mode == HINTED) {
-                BoardOptimalMove optMove;
-                if (alphabeta)
-                    optMove = currentTreeRoot->getOptimalMoveAlphaBeta(searchDepth, -WIN_SCORE - 1, WIN_SCORE + 1);
-                else
-                    optMove = currentTreeRoot->getOptimalMove(searchDepth);
-                cout << "Estimated best score: " << optMove.score << endl;
-                cout << "Row: " << optMove.coords.row << endl;
-                cout << "Col: " << optMove.coords.col << endl;
+                // The hint also shows how good every other move is, and the expected continuation
+                BoardSearchResult analysis;
+                BoardOptimalMove optMove = searchMove(&analysis);
+                const bool analyzed = analysis.best.score != ILLEGAL;
+                if (format == JSON) {
+                    cout << "{\"hint\":true,\"row\":" << optMove.coords.row << ",\"col\":" << optMove.coords.col
+                         << ",\"score\":" << optMove.score << ",\"nodes\":" << lastSearch.nodes << ",\"timeUs\":" << lastSearch.timeUs;
+                    if (analyzed) {
+                        cout << ",\"scores\":[";
+                        for (int k = 0; k < BOARD_SIZE * BOARD_SIZE; ++k) {
+                            const int moveScore = analysis.moveScores[k / BOARD_SIZE][k % BOARD_SIZE];
+                            if (k > 0) cout << ",";
+                            if (moveScore == ILLEGAL) cout << "null";
+                            else cout << moveScore;
+                        }
+                        cout << "],\"pv\":[";
+                        for (int k = 0; k < analysis.pv.count; ++k) {
+                            cout << (k > 0 ? "," : "") << "[" << analysis.pv[k].row << "," << analysis.pv[k].col << "]";
+                        }
+                        cout << "]";
+                    }
+                    cout << "}\n";
+                }
+                else {
+                    cout << "Estimated best score: " << optMove.score << '\n';
+                    cout << "Row: " << optMove.coords.row << '\n';
+                    cout << "Col: " << optMove.coords.col << '\n';
+                    if (analyzed && format == TEXT) {
+                        cout << "Score of each move:" << '\n';
+                        printBoard<int, string>(cout, analysis.moveScores, [](const int x)->string { return x == ILLEGAL ? "-" : to_string(x); });
+                        cout << "Expected continuation:";
+                        for (int k = 0; k < analysis.pv.count; ++k) {
+                            cout << " (" << analysis.pv[k].row << ", " << analysis.pv[k].col << ")";
+                        }
+                        cout << '\n';
+                    }
+                }
             }
             // Player
             int row, col;
             do {
-                cout << "Select a row from 0 to " << BOARD_SIZE - 1 << " (top to bottom). Type -1 to quit game." << endl;
+                prompt << "Select a row from 0 to " << BOARD_SIZE - 1 << " (top to bottom). Type -1 to quit game." << '\n';
                 cin >> row;
             } while (row < -1 || row >= BOARD_SIZE);
             if (row == -1) break;
             do {
-                cout << "Select a column from 0 to " << BOARD_SIZE - 1 << " (left to right). Type -1 to quit game." << endl;
+                prompt << "Select a column from 0 to " << BOARD_SIZE - 1 << " (left to right). Type -1 to quit game." << '\n';
                 cin >> col;
             } while (col < -1 || col >= BOARD_SIZE);
             if (col == -1) break;
             move = BoardCoordinate{row, col};
         }
 
-        board.play(move);
+        // A player can select an occupied cell, which play() rejects. Ask again before the move is recorded or the tree moves on.
+        if (!board.play(move)) {
+            prompt << "Cell (" << move.row << ", " << move.col << ") is not empty." << '\n';
+            continue;
+        }
+        if (recordWriter) {
+            RecordedMove record = engineMove ? lastSearch : RecordedMove();
+            record.cell = move.row * BOARD_SIZE + move.col;
+            recordWriter->addMove(record);
+        }
+        // The other moves can no longer be reached, so their subtrees are only taking up memory
+        if (backgroundFree)
+            currentTreeRoot->clearSubTrees(move, true);
         currentTreeRoot = currentTreeRoot->getSubTree(move);
-        cout << board;
 
         int boardScore = board.getBoardScore();
-        cout << "Score: " << boardScore << endl;
-        cout << "ID: " << board.getID() << endl;
+        if (format == TEXT) {
+            cout << board;
+            cout << "Score: " << boardScore << '\n';
+            cout << "ID: " << board.getID() << '\n';
+        }
+        else if (format == JSON) {
+            cout << "{\"ply\":" << plies + 1 << ",\"player\":\"" << cell2chr(board.getCurPlayer() == X ? O : X) << "\",\"row\":" << move.row
+                 << ",\"col\":" << move.col << ",\"engine\":" << (engineMove ? "true" : "false") << ",\"boardScore\":" << boardScore;
+            if (engineMove)
+                cout << ",\"score\":" << lastSearch.score << ",\"nodes\":" << lastSearch.nodes << ",\"timeUs\":" << lastSearch.timeUs;
+            cout << "}\n";
+        }
+        ++plies;
 
         if (boardScore == WIN_SCORE) {
-            cout << "Player X won!" << endl;
+            result = "Player X won!";
             break;
         }
         else if (boardScore == -WIN_SCORE) {
-            cout << "Player O won!" << endl;
+            result = "Player O won!";
             break;
         }
         else if (board.isFull()) {
             if (boardScore > 0) {
-                cout << "Player X won!" << endl;
+                result = "Player X won!";
             }
             else if (boardScore < 0) {
-                cout << "Player O won!" << endl;
+                result = "Player O won!";
             }
             else {
-                cout << "Draw!" << endl;
+                result = "Draw!";
             }
             break;
         }
     }
     chrono::steady_clock::time_point end = chrono::steady_clock::now();
-    if (mode == AUTO) cout << "Took " << chrono::duration_cast<chrono::milliseconds>(end - begin).count() << " milliseconds." << endl;
+    if (recordWriter) {
+        // A quit game is left without its end record, so it reads back as unfinished
+        if (result != nullptr) {
+            recordWriter->endGame(board.getBoardScore());
+        }
+        delete recordWriter;
+    }
+    const long long ms = chrono::duration_cast<chrono::milliseconds>(end - begin).count();
+    if (format == JSON) {
+        const int boardScore = board.getBoardScore();
+        cout << "{\"result\":\"" << (result == nullptr ? "quit" : boardScore > 0 ? "X" : boardScore < 0 ? "O" : "draw")
+             << "\",\"boardScore\":" << boardScore << ",\"plies\":" << plies << ",\"timeMs\":" << ms << "}" << endl;
+    }
+    else {
+        if (result != nullptr) cout << result << '\n';
+        if (mode == AUTO) cout << "Took " << ms << " milliseconds." << endl;
+    }
 
     // BoardHashTable::getInstance().clearTable();
 
+#ifdef PA3_PROFILE
+    if (!tracePath.empty() && !PhaseProfile::getInstance().writeTrace(tracePath)) {
+        cout << "Cannot write " << tracePath << "." << endl;
+    }
+#endif
+
+    // Deleting a large tree can take seconds, and the operating system frees the memory at exit anyway
+    if (fastExit) {
+        cout.flush();
+        _Exit(0);
+    }
+
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,190 @@
+#include <cmath>
+#include <thread>
+#include <vector>
+#include "mcts.h"
+#include "const.h"
+
+// Scale of the root move scores. Playouts only estimate the result, so even a value of 1 (every playout won) must stay
+// below the win scores, which stand for a proven match (see isWinScore()).
+static const int MCTS_SCORE_SCALE = WIN_SCORE - MAX_PLIES - 1;
+
+// Xorshift64* generator. std::mt19937 is noticeably slower and its state is large, which matters since playouts
+// draw one random number per move.
+static inline unsigned long long nextRandom(unsigned long long& state)
+{
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 2685821657736338717ULL;
+}
+
+// Return 1 if X has won, -1 if O has won, 0 for a draw and ILLEGAL if the game is not finished yet.
+// Following main_program.cpp, a full board without a match is won by the player with the higher score.
+static int getGameResult(const Board& board)
+{
+    const int boardScore = board.getBoardScore();
+    if (boardScore == WIN_SCORE) return 1;
+    if (boardScore == -WIN_SCORE) return -1;
+    if (!board.isFull()) return ILLEGAL;
+    return (boardScore > 0) - (boardScore < 0);
+}
+
+// Play uniformly random moves from board until the game ends and return the result as in getGameResult().
+static int playout(Board board, unsigned long long& rng)
+{
+    int result = getGameResult(board);
+    while (result == ILLEGAL) {
+        MoveList moves;
+        board.getLegalMoves(moves);
+        const int cell = moves.cells[nextRandom(rng) % moves.count];
+        board.play(BoardCoordinate(cell / BOARD_SIZE, cell % BOARD_SIZE));
+        result = getGameResult(board);
+    }
+    return result;
+}
+
+// MCTSEngine::searchTree
+//  Run the four MCTS steps (selection, expansion, simulation, backpropagation) until the budget is used up.
+//  Rewards are stored from the view of the player who made the move into a node, so that selection at every level can
+//  simply maximize the UCT value of the children.
+unsigned long long MCTSEngine::searchTree(const Board& board, const unsigned int iterations, const unsigned long long seed,
+                                          unsigned long long rootVisits[], double rootReward[]) const
+{
+    std::vector<MCTSNode> pool;
+    pool.reserve(1 + (iterations ? iterations : 4096) * 2);
+    pool.push_back(MCTSNode(0));
+
+    std::vector<int> path;
+    path.reserve(BOARD_SIZE * BOARD_SIZE + 1);
+
+    unsigned long long rng = seed | 1;
+    unsigned long long done = 0;
+    while (iterations == 0 || done < iterations) {
+        // Checking the clock is comparatively expensive, so only do it every 64 iterations
+        if (limits.timeLimitMs && done && (done & 63) == 0 && std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+
+        Board current = board;
+        int node = 0;
+        path.clear();
+        path.push_back(node);
+
+        // Selection: descend through expanded nodes, visiting every child once before using UCT
+        while (pool[node].firstChild >= 0 && pool[node].childCount > 0) {
+            const double logVisits = std::log(static_cast<double>(pool[node].visits));
+            int best = -1;
+            double bestValue = -1e300;
+            for (int c = pool[node].firstChild; c < pool[node].firstChild + pool[node].childCount; ++c) {
+                if (pool[c].visits == 0) {
+                    best = c;
+                    break;
+                }
+                const double value = pool[c].reward / pool[c].visits + limits.exploration * std::sqrt(logVisits / pool[c].visits);
+                if (value > bestValue) {
+                    bestValue = value;
+                    best = c;
+                }
+            }
+            node = best;
+            current.play(BoardCoordinate(pool[node].move / BOARD_SIZE, pool[node].move % BOARD_SIZE));
+            path.push_back(node);
+        }
+
+        // Expansion: add all candidate moves as children of the first node that has been visited before
+        int result = getGameResult(current);
+        if (result == ILLEGAL && pool[node].firstChild < 0 && (node == 0 || pool[node].visits > 0)) {
+            const int firstChild = static_cast<int>(pool.size());
+            MoveList moves;
+            current.getCandidateMoves(moves, limits.candidateRadius);
+            for (int k = 0; k < moves.count; ++k) {
+                pool.push_back(MCTSNode(static_cast<unsigned short>(moves.cells[k])));
+            }
+            // pool may have been reallocated, so index it again instead of keeping a reference
+            pool[node].firstChild = firstChild;
+            pool[node].childCount = static_cast<unsigned short>(pool.size() - firstChild);
+            node = firstChild;
+            current.play(BoardCoordinate(pool[node].move / BOARD_SIZE, pool[node].move % BOARD_SIZE));
+            path.push_back(node);
+            result = getGameResult(current);
+        }
+
+        // Simulation
+        if (result == ILLEGAL) {
+            result = playout(current, rng);
+        }
+
+        // Backpropagation. The root is "moved into" by the opponent of the player to move at the root.
+        int mover = (board.getCurPlayer() == X) ? O : X;
+        for (int k = 0; k < static_cast<int>(path.size()); ++k) {
+            pool[path[k]].visits++;
+            pool[path[k]].reward += static_cast<float>(result * mover);
+            mover = -mover;
+        }
+        ++done;
+    }
+
+    if (pool[0].firstChild >= 0) {
+        for (int c = pool[0].firstChild; c < pool[0].firstChild + pool[0].childCount; ++c) {
+            rootVisits[pool[c].move] += pool[c].visits;
+            rootReward[pool[c].move] += pool[c].reward;
+        }
+    }
+    return done;
+}
+
+// MCTSEngine::getOptimalMove
+//  Split the iteration budget over the threads, search independent trees and pick the root move with the most visits
+//  over all trees. Returns an illegal move if the game has already finished.
+BoardOptimalMove MCTSEngine::getOptimalMove(const Board& board)
+{
+    iterations = 0;
+    if (board.isFinished()) {
+        return BoardOptimalMove();
+    }
+
+    const unsigned int threadCount = limits.threads ? limits.threads : 1;
+    unsigned int perThread = 0;
+    if (limits.iterations) {
+        perThread = (limits.iterations + threadCount - 1) / threadCount;
+    } else if (!limits.timeLimitMs) {
+        perThread = (MCTS_ITERATIONS_PRESET + threadCount - 1) / threadCount;
+    }
+    deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(limits.timeLimitMs);
+
+    std::vector<unsigned long long> visits(threadCount * BOARD_SIZE * BOARD_SIZE, 0);
+    std::vector<double> reward(threadCount * BOARD_SIZE * BOARD_SIZE, 0);
+    std::vector<unsigned long long> done(threadCount, 0);
+    std::vector<std::thread> workers;
+    for (unsigned int t = 1; t < threadCount; ++t) {
+        workers.push_back(std::thread([&, t]() {
+            done[t] = searchTree(board, perThread, board.getID() + 0x9E3779B97F4A7C15ULL * (t + 1),
+                                 &visits[t * BOARD_SIZE * BOARD_SIZE], &reward[t * BOARD_SIZE * BOARD_SIZE]);
+        }));
+    }
+    done[0] = searchTree(board, perThread, board.getID() + 0x9E3779B97F4A7C15ULL, &visits[0], &reward[0]);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    BoardOptimalMove bestMove;
+    unsigned long long bestVisits = 0;
+    for (int cell = 0; cell < BOARD_SIZE * BOARD_SIZE; ++cell) {
+        unsigned long long cellVisits = 0;
+        double cellReward = 0;
+        for (unsigned int t = 0; t < threadCount; ++t) {
+            cellVisits += visits[t * BOARD_SIZE * BOARD_SIZE + cell];
+            cellReward += reward[t * BOARD_SIZE * BOARD_SIZE + cell];
+        }
+        if (cellVisits > bestVisits) {
+            bestVisits = cellVisits;
+            // Rewards are from the view of the player to move, while scores are always from the view of X
+            const double value = cellReward / cellVisits * board.getCurPlayer();
+            bestMove = BoardOptimalMove(static_cast<int>(value * MCTS_SCORE_SCALE), BoardCoordinate(cell / BOARD_SIZE, cell % BOARD_SIZE));
+        }
+    }
+    for (unsigned int t = 0; t < threadCount; ++t) {
+        iterations += done[t];
+    }
+    return bestMove;
+}
\ No newline at end of file
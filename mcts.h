@@ -0,0 +1,55 @@
+#ifndef __MCTS_H__
+#define __MCTS_H__
+
+#include <chrono>
+#include "board.h"
+#include "const.h"
+
+// Budget and tuning for one MCTS search. The search stops when either the iteration or the time budget runs out.
+// A budget of 0 means "unlimited", but at least one of them has to be set.
+struct MCTSLimits {
+    unsigned int iterations {MCTS_ITERATIONS_PRESET}; // Total playouts over all threads
+    unsigned int timeLimitMs {0};                     // Wall clock budget in milliseconds
+    unsigned int threads {1};                         // Number of independent root-parallel trees
+    double exploration {MCTS_EXPLORATION};            // UCT exploration constant
+    int candidateRadius {CANDIDATE_RADIUS_PRESET};    // Moves added by the expansion, see Board::getCandidateMoves()
+};
+
+// Monte Carlo Tree Search (UCT) engine. Unlike BoardTree, it does not need a full-width tree, so its cost grows with the
+// iteration budget instead of BOARD_SIZE ^ depth, and it can be stopped at any time with a usable answer.
+// Each thread grows its own tree from the same root (root parallelization) and the root visit counts are summed at the end.
+class MCTSEngine {
+    private:
+        // Nodes live in a flat pool and refer to each other by index. The children of a node are created together when
+        // it is expanded, so they are stored contiguously starting at firstChild.
+        struct MCTSNode {
+            int firstChild;         // Index of the first child in the pool, -1 if not expanded yet
+            unsigned short childCount;
+            unsigned short move;    // Cell index (row * BOARD_SIZE + col) of the move leading to this node
+            unsigned int visits;
+            float reward;           // Sum of playout results from the view of the player who played move
+
+            MCTSNode(const unsigned short move): firstChild(-1), childCount(0), move(move), visits(0), reward(0) {}
+        };
+
+        MCTSLimits limits;
+        std::chrono::steady_clock::time_point deadline;
+        unsigned long long iterations {0};
+
+        // Grow one tree from board and accumulate the visit count of each root move into rootVisits.
+        // rootReward accumulates the reward of each root move from the view of the player to move at the root.
+        unsigned long long searchTree(const Board& board, const unsigned int iterations, const unsigned long long seed,
+                                      unsigned long long rootVisits[], double rootReward[]) const;
+
+    public:
+        MCTSEngine(const MCTSLimits& limits): limits(limits) {}
+
+        // Return the most visited root move. Its score is the expected game result scaled to just below the win scores
+        // (|score| < WIN_SCORE - MAX_PLIES), positive meaning good for X, like the scores returned by BoardTree.
+        BoardOptimalMove getOptimalMove(const Board& board);
+
+        // Number of playouts run by the last call to getOptimalMove()
+        unsigned long long getIterations() const { return iterations; }
+};
+
+#endif // __MCTS_H__
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "profiler.h"
+
+#ifdef PA3_PROFILE
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+
+// Clock readings taken when the program starts, to convert ticks to time and to give the trace a zero point
+static const unsigned long long startTicks = PhaseProfile::now();
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+static const char* const PHASE_NAMES[PROFILE_PHASE_COUNT] = {"search", "play", "eval", "probe", "store", "alloc"};
+
+// PhaseProfile::getTicksPerUs
+//  The time stamp counter runs at a fixed rate on current CPUs, but the rate is not known in advance, so it is compared
+//  with steady_clock over the whole run so far.
+double PhaseProfile::getTicksPerUs()
+{
+    const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+    const unsigned long long elapsed = now() - startTicks;
+    return us > 0 ? elapsed / us : 1.0;
+}
+
+// PhaseProfile::reset
+void PhaseProfile::reset()
+{
+    for (int p = 0; p < PROFILE_PHASE_COUNT; ++p) {
+        ticks[p] = 0;
+        calls[p] = 0;
+    }
+}
+
+// PhaseProfile::printReport
+//  Every phase is shown with its self time, its share of all profiled time and its average cost per call. Each scope
+//  costs two clock readings, which are included in the times of the short phases.
+void PhaseProfile::printReport(std::ostream& os) const
+{
+    const double ticksPerUs = getTicksPerUs();
+    unsigned long long total = 0;
+    for (int p = 0; p < PROFILE_PHASE_COUNT; ++p) {
+        total += ticks[p];
+    }
+    os << "Phase profile (self time):" << '\n';
+    for (int p = 0; p < PROFILE_PHASE_COUNT; ++p) {
+        os << "  " << std::left << std::setw(8) << PHASE_NAMES[p] << std::right
+           << std::setw(10) << static_cast<long long>(ticks[p] / ticksPerUs) << " us "
+           << std::setw(6) << std::fixed << std::setprecision(1) << (total ? 100.0 * ticks[p] / total : 0.0) << "% "
+           << std::setw(10) << calls[p] << " calls "
+           << std::setw(8) << (calls[p] ? 1000.0 * ticks[p] / ticksPerUs / calls[p] : 0.0) << " ns/call" << '\n';
+    }
+    os.unsetf(std::ios::fixed);
+    if (droppedEvents > 0) {
+        os << "  Trace is full, " << droppedEvents << " scopes were not recorded." << '\n';
+    }
+}
+
+// PhaseProfile::writeTrace
+//  Each scope becomes a complete ("X") event. Nested scopes are shown inside their parent by the trace viewers.
+bool PhaseProfile::writeTrace(const std::string& path) const
+{
+    std::ofstream file{path};
+    if (!file) {
+        return false;
+    }
+    const double ticksPerUs = getTicksPerUs();
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    for (size_t k = 0; k < trace.size(); ++k) {
+        const TraceEvent& event = trace[k];
+        file << (k ? ",\n" : "\n")
+             << "{\"name\":\"" << PHASE_NAMES[event.phase] << "\",\"cat\":\"search\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+             << ",\"ts\":" << (event.start - startTicks) / ticksPerUs
+             << ",\"dur\":" << event.duration / ticksPerUs << "}";
+    }
+    file << "\n]}\n";
+    return static_cast<bool>(file);
+}
+
+#endif // PA3_PROFILE
\ No newline at end of file
@@ -0,0 +1,134 @@
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "const.h"
+
+// Phase profiler of the search hot path. It is only compiled in with -DPA3_PROFILE (make profile). Otherwise
+// PROFILE_SCOPE() expands to nothing, so the other builds do not pay anything for it.
+//
+// PROFILE_SCOPE(phase) times the rest of the enclosing block as phase. Scopes can be nested, and each phase only counts
+// its own (self) time, e.g. the Board::play() inside a node allocation counts as PROFILE_PLAY and not as PROFILE_ALLOC.
+
+enum ProfilePhase {
+    PROFILE_SEARCH, // Search time outside of the phases below (tree walk, move generation and ordering, ...)
+    PROFILE_PLAY,   // Board::play(), including the line counts and the ID update
+    PROFILE_EVAL,   // Static evaluation of the leaves (Board::getBoardScore())
+    PROFILE_PROBE,  // Transposition table probes
+    PROFILE_STORE,  // Transposition table updates
+    PROFILE_ALLOC,  // Node allocation in BoardTree::getSubTree()
+    PROFILE_PHASE_COUNT
+};
+
+#ifdef PA3_PROFILE
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+// Time spent in each phase by one thread. There is one instance per thread, like SearchStats.
+class PhaseProfile {
+    private:
+        // One timed scope, for the Chrome trace
+        struct TraceEvent {
+            unsigned long long start;
+            unsigned long long duration;
+            ProfilePhase phase;
+        };
+
+        unsigned long long ticks[PROFILE_PHASE_COUNT] {};
+        unsigned long long calls[PROFILE_PHASE_COUNT] {};
+        std::vector<TraceEvent> trace;
+        unsigned long long droppedEvents {0};
+        bool tracing {false};
+
+    public:
+        // Return the instance of the calling thread
+        static PhaseProfile& getInstance()
+        {
+            static thread_local PhaseProfile instance;
+            return instance;
+        }
+
+        // Current time in ticks: the time stamp counter on x86, otherwise nanoseconds
+        static unsigned long long now()
+        {
+#if defined(__x86_64__) || defined(__i386__)
+            return __rdtsc();
+#else
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+        }
+
+        // Number of ticks per microsecond, measured since the program started
+        static double getTicksPerUs();
+
+        // Count a finished scope. total includes the nested scopes, self does not.
+        void add(const ProfilePhase phase, const unsigned long long start, const unsigned long long total, const unsigned long long self)
+        {
+            ticks[phase] += self;
+            calls[phase]++;
+            if (tracing) {
+                if (trace.size() < PROFILE_TRACE_EVENTS) trace.push_back(TraceEvent{start, total, phase});
+                else droppedEvents++;
+            }
+        }
+
+        // Reset the phase times, e.g. before every search. The trace is kept.
+        void reset();
+
+        // Record every scope from now on, up to PROFILE_TRACE_EVENTS, for writeTrace()
+        void setTracing(const bool enabled) { tracing = enabled; }
+
+        // Print the time, share and number of calls of each phase since the last reset()
+        void printReport(std::ostream& os) const;
+
+        // Write the recorded scopes in the Chrome trace event format (chrome://tracing or Perfetto). Return false if
+        // the file cannot be written.
+        bool writeTrace(const std::string& path) const;
+};
+
+// Times its own lifetime as a phase, see PROFILE_SCOPE()
+class ProfileTimer {
+    private:
+        inline static thread_local ProfileTimer* current {nullptr}; // Innermost scope of the thread
+        ProfileTimer* parent;
+        const ProfilePhase phase;
+        const unsigned long long start;
+        unsigned long long childTicks {0};
+
+    public:
+        explicit ProfileTimer(const ProfilePhase phase): parent(current), phase(phase), start(PhaseProfile::now())
+        {
+            current = this;
+        }
+
+        ~ProfileTimer()
+        {
+            const unsigned long long total = PhaseProfile::now() - start;
+            PhaseProfile::getInstance().add(phase, start, total, total - childTicks);
+            if (parent != nullptr) {
+                parent->childTicks += total;
+            }
+            current = parent;
+        }
+
+        ProfileTimer(const ProfileTimer&) = delete;
+        ProfileTimer& operator=(const ProfileTimer&) = delete;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(phase) ProfileTimer PROFILE_CONCAT(profileTimer, __LINE__){phase}
+
+#else
+
+#define PROFILE_SCOPE(phase) ((void)0)
+
+#endif // PA3_PROFILE
+
+#endif // __PROFILER_H__
\ No newline at end of file
@@ -0,0 +1,242 @@
+#include <algorithm>
+#include "proofsearch.h"
+#include "hashtable.h"
+#include "search.h"
+#include "const.h"
+
+// Proof numbers are saturated at this value, which stands for "cannot be proven".
+static const unsigned int PN_INFINITY = 100000000;
+
+ProofNumberSearch::ProofNumberSearch(const unsigned int tableSize, const unsigned long long nodeLimit):
+    table((tableSize < 2 ? 2 : tableSize) & ~1u), nodeLimit(nodeLimit)
+{
+}
+
+// unsigned long long ProofNumberSearch::getKey(const unsigned long long id) const
+//  The stored numbers depend on who the attacker is, so the same board gets a different key for each attacker.
+unsigned long long ProofNumberSearch::getKey(const unsigned long long id) const
+{
+    return (attacker == X) ? id : id ^ 0x9E3779B97F4A7C15ULL;
+}
+
+// void ProofNumberSearch::lookup(const unsigned long long id, unsigned int& phi, unsigned int& delta) const
+//  Unknown boards get the usual initial value of 1 for both numbers.
+void ProofNumberSearch::lookup(const unsigned long long id, unsigned int& phi, unsigned int& delta) const
+{
+    const unsigned long long bucket = getBucket(id);
+    for (unsigned long long k = bucket; k < bucket + 2; ++k) {
+        if (table[k].work != 0 && table[k].id == id) {
+            phi = table[k].phi;
+            delta = table[k].delta;
+            return;
+        }
+    }
+    phi = 1;
+    delta = 1;
+}
+
+// void ProofNumberSearch::store(const unsigned long long id, const unsigned int phi, const unsigned int delta, const unsigned int work)
+//  Overwrite the entry of the same board if there is one. Otherwise take an empty slot, or replace the entry that took
+//  less work to compute, since it is the cheaper one to recompute.
+void ProofNumberSearch::store(const unsigned long long id, const unsigned int phi, const unsigned int delta, const unsigned int work)
+{
+    const unsigned long long bucket = getBucket(id);
+    unsigned long long victim = bucket;
+    for (unsigned long long k = bucket; k < bucket + 2; ++k) {
+        if (table[k].work == 0 || table[k].id == id) {
+            victim = k;
+            break;
+        }
+        if (table[k].work < table[victim].work) {
+            victim = k;
+        }
+    }
+    table[victim].id = id;
+    table[victim].phi = phi;
+    table[victim].delta = delta;
+    table[victim].work = (work == 0) ? 1 : work;
+}
+
+// static void setSolved(const bool sideToMoveWon, unsigned int& phi, unsigned int& delta)
+//  Numbers of a solved position from the view of the player to move.
+static void setSolved(const bool sideToMoveWon, unsigned int& phi, unsigned int& delta)
+{
+    phi = sideToMoveWon ? 0 : PN_INFINITY;
+    delta = sideToMoveWon ? PN_INFINITY : 0;
+}
+
+// bool ProofNumberSearch::evaluateTerminal(const Board& board, unsigned int& phi, unsigned int& delta) const
+//  The player to move "wins" a finished game if they are the attacker and the attacker has a match, or if they are the
+//  defender and the attacker has none. A full board without a match counts as a defender win regardless of the score.
+bool ProofNumberSearch::evaluateTerminal(const Board& board, unsigned int& phi, unsigned int& delta) const
+{
+    const int boardScore = board.getBoardScore();
+    bool attackerWon;
+    if (boardScore == WIN_SCORE || boardScore == -WIN_SCORE) {
+        attackerWon = (boardScore == WIN_SCORE) == (attacker == X);
+    } else if (board.isFull()) {
+        attackerWon = false;
+    } else {
+        return false;
+    }
+    setSolved(attackerWon == (board.getCurPlayer() == attacker), phi, delta);
+    return true;
+}
+
+// bool ProofNumberSearch::evaluateForcedWin(const Board& board, unsigned int& phi, unsigned int& delta) const
+//  Either the attacker forces a match, or the defender forces one first and the attacker never gets one. The distance
+//  does not matter here, so upper bounds are used as well.
+bool ProofNumberSearch::evaluateForcedWin(const Board& board, unsigned int& phi, unsigned int& delta) const
+{
+    bool exact;
+    const BoardOptimalMove forcedWin = SearchOptions::getInstance().getHashTable().getForcedWin(board.getID(), exact);
+    if (forcedWin.score == ILLEGAL) {
+        return false;
+    }
+    const bool attackerWon = (forcedWin.score > 0) == (attacker == X);
+    setSolved(attackerWon == (board.getCurPlayer() == attacker), phi, delta);
+    return true;
+}
+
+// void ProofNumberSearch::mid(Board& board, const unsigned int phiThreshold, const unsigned int deltaThreshold)
+//  Negamax formulation of df-pn: phi(n) is the minimum delta of the children and delta(n) is the sum of phi of the
+//  children. The most proving child is searched with thresholds chosen so that control returns here as soon as another
+//  child becomes more promising. Children are only kept as their table keys.
+void ProofNumberSearch::mid(Board& board, const unsigned int phiThreshold, const unsigned int deltaThreshold)
+{
+    const unsigned long long nodesBefore = nodes++;
+
+    unsigned int phi, delta;
+    const unsigned long long key = getKey(board.getID());
+    if (evaluateTerminal(board, phi, delta) || evaluateForcedWin(board, phi, delta)) {
+        store(key, phi, delta, 1);
+        return;
+    }
+
+    MoveList moves;
+    board.getLegalMoves(moves);
+    MoveList threats;
+    board.getThreatCells(board.getCurPlayer(), threats);
+    unsigned long long childKeys[BOARD_SIZE * BOARD_SIZE];
+    for (int k = 0; k < moves.count; ++k) {
+        childKeys[k] = getKey(board.getChildID(moves[k]));
+        __builtin_prefetch(&table[getBucket(childKeys[k])]);
+        // Only a move completing a match or filling the last cell can end the game
+        if (threats.contains(moves[k]) || moves.count == 1) {
+            board.play(moves[k]);
+            unsigned int childPhi, childDelta;
+            if (evaluateTerminal(board, childPhi, childDelta)) {
+                store(childKeys[k], childPhi, childDelta, 1);
+            }
+            board.undo(moves[k]);
+        }
+    }
+
+    while (true) {
+        // Recompute the numbers of this node from the children
+        phi = PN_INFINITY;
+        delta = 0;
+        int best = -1;
+        unsigned int bestDelta = PN_INFINITY, secondDelta = PN_INFINITY, bestPhi = PN_INFINITY;
+        for (int k = 0; k < moves.count; ++k) {
+            unsigned int childPhi, childDelta;
+            lookup(childKeys[k], childPhi, childDelta);
+            delta = (delta + childPhi > PN_INFINITY) ? PN_INFINITY : delta + childPhi;
+            if (best == -1 || childDelta < bestDelta) {
+                secondDelta = bestDelta;
+                bestDelta = childDelta;
+                bestPhi = childPhi;
+                best = k;
+            } else if (childDelta < secondDelta) {
+                secondDelta = childDelta;
+            }
+        }
+        phi = bestDelta;
+
+        store(key, phi, delta, static_cast<unsigned int>(nodes - nodesBefore));
+        if (phi >= phiThreshold || delta >= deltaThreshold || nodes >= nodeLimit) {
+            return;
+        }
+
+        unsigned long long childPhiThreshold = static_cast<unsigned long long>(deltaThreshold) - delta + bestPhi;
+        if (childPhiThreshold > PN_INFINITY) childPhiThreshold = PN_INFINITY;
+        const unsigned int childDeltaThreshold = std::min(phiThreshold, secondDelta == PN_INFINITY ? PN_INFINITY : secondDelta + 1);
+        board.play(moves[best]);
+        mid(board, static_cast<unsigned int>(childPhiThreshold), childDeltaThreshold);
+        board.undo(moves[best]);
+    }
+}
+
+// ProofOutcome ProofNumberSearch::prove(const Board& board, const Cell attacker)
+//  Search the board from the view of attacker, who does not have to be the player to move.
+//  If the attacker is to move and the win is proven, a winning move is a child whose delta is 0, i.e. a child in which the
+//  defender (to move) is lost.
+ProofOutcome ProofNumberSearch::prove(const Board& position, const Cell attacker)
+{
+    this->attacker = attacker;
+    nodes = 0;
+
+    Board board = position;
+    mid(board, PN_INFINITY, PN_INFINITY);
+
+    ProofOutcome outcome;
+    outcome.nodes = nodes;
+    unsigned int phi, delta;
+    lookup(getKey(board.getID()), phi, delta);
+    const bool attackerToMove = board.getCurPlayer() == attacker;
+    if ((attackerToMove ? phi : delta) == 0) {
+        outcome.result = PROVEN;
+    } else if ((attackerToMove ? delta : phi) == 0) {
+        outcome.result = DISPROVEN;
+    }
+
+    if (outcome.result == PROVEN && attackerToMove) {
+        // A win that was already in the forced win table keeps its move and distance
+        BoardHashTable& hashTable = SearchOptions::getInstance().getHashTable();
+        bool exact;
+        const BoardOptimalMove forcedWin = hashTable.getForcedWin(board.getID(), exact);
+        if (forcedWin.score != ILLEGAL && (forcedWin.score > 0) == (attacker == X)) {
+            outcome.move = forcedWin.coords;
+            outcome.score = forcedWin.score;
+            return outcome;
+        }
+
+        MoveList moves;
+        board.getLegalMoves(moves);
+        for (int k = 0; k < moves.count && !outcome.move.isValid(); ++k) {
+            unsigned int childPhi, childDelta;
+            lookup(getKey(board.getChildID(moves[k])), childPhi, childDelta);
+            if (childDelta == 0) {
+                outcome.move = moves[k];
+            }
+        }
+        // The child entries may have been replaced in the table, in which case they are solved again one by one
+        for (int k = 0; k < moves.count && !outcome.move.isValid() && nodes < nodeLimit; ++k) {
+            unsigned int childPhi, childDelta;
+            board.play(moves[k]);
+            mid(board, PN_INFINITY, PN_INFINITY);
+            board.undo(moves[k]);
+            lookup(getKey(board.getChildID(moves[k])), childPhi, childDelta);
+            if (childDelta == 0) {
+                outcome.move = moves[k];
+            }
+        }
+        outcome.nodes = nodes;
+        // A forced match does not depend on the score grid or the depth, so it goes to the forced win table. The proof
+        // does not look for the fastest match, so the number of empty cells is only an upper bound of its distance.
+        if (outcome.move.isValid()) {
+            outcome.score = getWinScore(attacker, BOARD_SIZE * BOARD_SIZE - board.getMoveCount());
+            hashTable.storeForcedWin(board.getID(), BoardOptimalMove(outcome.score, outcome.move), false);
+        }
+    }
+    return outcome;
+}
+
+// void ProofNumberSearch::clearTable()
+//  Reset every entry to empty.
+void ProofNumberSearch::clearTable()
+{
+    for (ProofEntry& entry : table) {
+        entry = ProofEntry();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef __PROOFSEARCH_H__
+#define __PROOFSEARCH_H__
+
+#include <vector>
+#include "board.h"
+#include "const.h"
+
+enum ProofResult {
+    PROVEN,    // The attacker can force a match (a full row, column or diagonal)
+    DISPROVEN, // The defender can always prevent a match
+    UNKNOWN,   // The node budget ran out before the position was solved
+};
+
+struct ProofOutcome {
+    ProofResult result;
+    BoardCoordinate move;        // A winning move if the attacker is to move and the result is PROVEN, else (-1, -1)
+    unsigned long long nodes;    // Number of nodes expanded by the search
+    int score;                   // Search score of move (see getWinScore()) if it is set, else 0. The search does not
+                                 // find the fastest win, so unless the forced win table already had a distance, it is the
+                                 // number of empty cells, an upper bound.
+
+    ProofOutcome(): result(UNKNOWN), move(BoardCoordinate(-1, -1)), nodes(0), score(0) {}
+};
+
+// Depth-first proof-number search (df-pn). It answers "can the attacker force a match from this position?" without
+// looking at the score grid, so it is much cheaper than a full-width minimax search for tactical questions.
+// Proof and disproof numbers are kept in a fixed-size table, so memory use is bounded no matter how long the search runs.
+class ProofNumberSearch {
+    private:
+        // Two entries share a bucket. An entry with work == 0 is empty.
+        struct ProofEntry {
+            unsigned long long id;
+            unsigned int phi;   // Proof number from the view of the player to move
+            unsigned int delta; // Disproof number from the view of the player to move
+            unsigned int work;  // Number of nodes expanded below this entry, used to decide which entry to replace
+
+            ProofEntry(): id(0), phi(0), delta(0), work(0) {}
+        };
+
+        std::vector<ProofEntry> table;
+        unsigned long long nodeLimit;
+        unsigned long long nodes {0};
+        Cell attacker {X};
+
+        // Table key of the board with the given ID for the current attacker
+        unsigned long long getKey(const unsigned long long id) const;
+
+        // Index of the first entry of the bucket of id
+        unsigned long long getBucket(const unsigned long long id) const { return (id % (table.size() / 2)) * 2; }
+
+        // Get the stored numbers of a board, or (1, 1) if it has not been searched yet.
+        void lookup(const unsigned long long id, unsigned int& phi, unsigned int& delta) const;
+        void store(const unsigned long long id, const unsigned int phi, const unsigned int delta, const unsigned int work);
+
+        // Return true if the game has finished, and set phi and delta to the value of the final position.
+        bool evaluateTerminal(const Board& board, unsigned int& phi, unsigned int& delta) const;
+        // Return true if the forced win table knows who wins board, and set phi and delta accordingly.
+        bool evaluateForcedWin(const Board& board, unsigned int& phi, unsigned int& delta) const;
+
+        // Multiple iterative deepening: search board until its numbers reach one of the thresholds. The children are
+        // played and taken back on board itself, which is unchanged when this returns.
+        void mid(Board& board, const unsigned int phiThreshold, const unsigned int deltaThreshold);
+
+    public:
+        ProofNumberSearch(const unsigned int tableSize = PN_TABLE_SIZE, const unsigned long long nodeLimit = PN_NODE_LIMIT);
+
+        // Try to prove that attacker can force a match from board. Forced wins already in the SearchOptions transposition
+        // table are used as solved positions.
+        // A proven win for the player to move is also stored in the forced win table of the SearchOptions transposition
+        // table, so later searches get it for free.
+        ProofOutcome prove(const Board& board, const Cell attacker);
+
+        // Forget all stored proof and disproof numbers.
+        void clearTable();
+};
+
+#endif // __PROOFSEARCH_H__
\ No newline at end of file
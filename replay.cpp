@@ -0,0 +1,117 @@
+#include <iostream>
+using namespace std;
+
+#include <cstdlib>
+#include <string>
+
+#include "board.h"
+#include "engine.h"
+#include "gamerecord.h"
+
+static const char* const ALGORITHM_NAMES[] = {"minimax", "alphabeta", "aspiration", "mcts"};
+
+int main(int argc, char* argv[]) {
+    string path;
+    bool verbose = false;
+    bool research = false;
+    string engineName;
+    SearchLimits limits;
+    unsigned int hashMB = HASH_MB_PRESET;
+
+    for (int i=1; i<argc; i++) {
+        string option = argv[i];
+        if (option == "-v" || option == "--verbose") {
+            verbose = true;
+        }
+        else if ((option == "-e" || option == "--engine") && i < argc - 1) {
+            engineName = argv[++i];
+            if (!parseSearchLimits(engineName, limits)) {
+                cout << "Unknown engine " << engineName << "." << endl;
+                return 0;
+            }
+            research = true;
+        }
+        else if (option == "--hash-mb" && i < argc - 1) {
+            hashMB = atoi(argv[++i]);
+        }
+        else if (option[0] != '-' && path.empty()) {
+            path = option;
+        }
+        else {
+            path.clear();
+            break;
+        }
+    }
+    if (path.empty()) {
+        cout << "Usage: pa3_replay.exe [file] [-v] [-e engine] [--hash-mb num]" << endl;
+        cout << "Prints the games of a record file written with --record." << endl;
+        cout << "-v or --verbose: \t Print every move with its recorded score, depth, nodes and time." << endl;
+        cout << "-e [spec] or --engine [spec]: \t Search every engine move again, given as minimax:depth, alphabeta:depth, aspiration:depth (optionally +lmr+futility) or mcts:iterations, and compare." << endl;
+        cout << "--hash-mb [num]: \t Transposition table size of the engine in megabytes." << endl;
+        return 0;
+    }
+
+    GameRecordReader reader{path};
+    if (!reader.isOpen()) {
+        cout << "Cannot open " << path << "." << endl;
+        return 0;
+    }
+
+    Engine engine{hashMB};
+    RecordedGame game;
+    int games = 0;
+    unsigned long long searches = 0, sameMoves = 0, sameScores = 0;
+    unsigned long long recordedNodes = 0, replayedNodes = 0;
+    long long recordedUs = 0, replayedUs = 0;
+
+    while (reader.readGame(game)) {
+        ++games;
+        cout << "Game " << games << ": " << game.moves.size() << " moves, ";
+        if (game.finished) cout << "final score " << game.result << endl;
+        else cout << "unfinished" << endl;
+
+        // Every recorded game was played with empty tables, so start each replay the same way to compare node counts
+        engine.clear();
+        Board board{game.score};
+        for (const RecordedMove& move : game.moves) {
+            if (verbose) {
+                cout << "  " << cell2chr(board.getCurPlayer()) << " (" << move.getCoords().row << ", " << move.getCoords().col << ")";
+                if (move.flags & RecordedMove::ENGINE) {
+                    cout << " " << (move.algorithm < 4 ? ALGORITHM_NAMES[move.algorithm] : "?") << ", score " << move.score
+                         << ", depth " << static_cast<int>(move.depth) << ", nodes " << move.nodes << ", " << move.timeUs << " us";
+                    if (move.flags & RecordedMove::PROVEN) cout << ", proven win";
+                }
+                cout << endl;
+            }
+
+            if (research && (move.flags & RecordedMove::ENGINE) && !board.isFinished()) {
+                SearchResult result = engine.search(board, limits);
+                const int cell = result.move.coords.row * BOARD_SIZE + result.move.coords.col;
+                ++searches;
+                sameMoves += (cell == move.cell);
+                sameScores += (result.move.score == move.score);
+                recordedNodes += move.nodes;
+                replayedNodes += result.nodes;
+                recordedUs += move.timeUs;
+                replayedUs += result.timeUs;
+                if (verbose && cell != move.cell) {
+                    cout << "    " << engineName << " plays (" << result.move.coords.row << ", " << result.move.coords.col
+                         << ") instead, score " << result.move.score << endl;
+                }
+            }
+
+            if (!board.play(move.getCoords())) {
+                cout << "  Illegal move (" << move.getCoords().row << ", " << move.getCoords().col << "), skipping the rest of the game." << endl;
+                break;
+            }
+        }
+    }
+
+    cout << games << " games read." << endl;
+    if (research) {
+        cout << engineName << " agrees with " << sameMoves << " of " << searches << " engine moves (" << sameScores << " with the same score)." << endl;
+        cout << "Recorded: " << recordedNodes << " nodes, " << recordedUs / 1000 << " ms. "
+             << engineName << ": " << replayedNodes << " nodes, " << replayedUs / 1000 << " ms." << endl;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+#ifndef __SEARCH_H__
+#define __SEARCH_H__
+
+#include "const.h"
+#include "hashtable.h"
+
+// Counters collected by the BoardTree search functions.
+// There is one instance per thread, so searches running on different threads do not mix up their numbers.
+struct SearchStats {
+    unsigned long long nodes {0}; // Number of nodes visited by getOptimalMove() and getOptimalMoveAlphaBeta()
+    unsigned int reSearches {0};  // Number of times an aspiration window failed and the depth had to be searched again
+    unsigned long long evictions {0}; // Number of subtrees collapsed to stay within SearchOptions::treeMB
+    unsigned long long reductions {0};    // Number of late moves searched with a reduced depth
+    unsigned long long verifications {0}; // Number of reduced searches repeated at full depth because the move looked good
+    unsigned long long futilityPrunes {0}; // Number of moves skipped by futility pruning
+
+    // Reset all counters to 0
+    void reset() { *this = SearchStats(); }
+
+    // Return the instance of the calling thread
+    static SearchStats& getInstance()
+    {
+        static thread_local SearchStats instance;
+        return instance;
+    }
+};
+
+// Optional search features of the BoardTree search functions. Like SearchStats, there is one instance per thread.
+struct SearchOptions {
+    // Keep searching forcing moves (completing or blocking a match) when the nominal depth runs out
+    bool threatExtension {false};
+    // Maximum number of extra plies searched by the threat extension
+    unsigned int maxExtension {THREAT_EXTENSION_PRESET};
+    // Only search the empty cells within this many rows and columns of a stone (see Board::getCandidateMoves()), 0 for all
+    int candidateRadius {CANDIDATE_RADIUS_PRESET};
+    // Selective alpha-beta search (both off by default, which keeps the search exact). Both can change the result:
+    // Search moves ordered late (after the hashed move, blocks and the most valuable cells) one ply less deep first, and
+    // only search them to the full depth if they turn out better than the best move so far
+    bool lateMoveReductions {false};
+    // Skip moves near the leaves whose cell (and the opponent's best reply) cannot lift the score into the window. Not used
+    // together with the threat extension, whose leaves can be worth more than their cells.
+    bool futilityPruning {false};
+    // Memory cap of a BoardTree in megabytes, 0 for no limit. When a search grows the tree beyond it, the least recently
+    // used subtrees are collapsed.
+    unsigned int treeMB {0};
+    // Transposition table used by the searches of this thread, nullptr for the shared BoardHashTable::getInstance()
+    BoardHashTable* hashTable {nullptr};
+
+    // Return the transposition table the searches of this thread should use
+    BoardHashTable& getHashTable() const { return hashTable ? *hashTable : BoardHashTable::getInstance(); }
+
+    // Return true if the searches skip moves (candidate radius, late move reductions or futility pruning). They can miss
+    // the only defence against a match, so their wins are no proofs and their scores are not those of a full search.
+    bool isSelective() const { return candidateRadius > 0 || lateMoveReductions || futilityPruning; }
+
+    // Mixed into the transposition table keys (like the grid fingerprint, see Board::getHashKey()), so that searches with
+    // different selective options never share entries. 0 for a full-width search.
+    unsigned long long getTableSalt() const
+    {
+        if (!isSelective()) return 0;
+        const unsigned long long options = static_cast<unsigned long long>(candidateRadius > 0 ? candidateRadius : 0) << 2
+                                           | lateMoveReductions << 1 | futilityPruning;
+        return options * 0xD6E8FEB86659FD93ULL;
+    }
+
+    // Return the instance of the calling thread
+    static SearchOptions& getInstance()
+    {
+        static thread_local SearchOptions instance;
+        return instance;
+    }
+};
+
+#endif // __SEARCH_H__
\ No newline at end of file
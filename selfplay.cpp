@@ -0,0 +1,193 @@
+#include <iostream>
+using namespace std;
+
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "board.h"
+#include "engine.h"
+#include "gamerecord.h"
+#include "threadpool.h"
+
+// One side of a match, parsed from "algorithm:depth" (or "mcts:iterations")
+struct PlayerSpec {
+    string name;
+    SearchLimits limits;
+};
+
+// Statistics of one game, written only by the task playing it
+struct GameRecord {
+    int result {0};                     // 1 if player A won, -1 if player B won, 0 for a draw
+    unsigned long long nodes[2] {0, 0}; // Nodes searched by player A and B
+    long long timeUs[2] {0, 0};         // Search time of player A and B
+    int moves[2] {0, 0};                // Number of searches of player A and B
+    RecordedGame game;                  // All moves, for --record
+};
+
+static bool parsePlayer(const string& text, PlayerSpec& spec)
+{
+    spec.name = text;
+    return parseSearchLimits(text, spec.limits);
+}
+
+// Xorshift64*, seeded per game so that every game is reproducible regardless of which thread plays it
+static unsigned long long nextRandom(unsigned long long& state)
+{
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 2685821657736338717ULL;
+}
+
+int main(int argc, char* argv[]) {
+    PlayerSpec players[2];
+    parsePlayer("minimax:3", players[0]);
+    parsePlayer("alphabeta:3", players[1]);
+    int games = 100;
+    unsigned int threads = thread::hardware_concurrency();
+    int openingPlies = 2;
+    unsigned long long seed = 1;
+    unsigned int hashMB = 4;
+    string recordPath;
+
+    for (int i=1; i<argc; i++) {
+        string option = argv[i];
+        if (option == "-h" || option == "--help" || i == argc - 1) {
+            cout << "Plays engine A against engine B and reports the aggregate result from A's point of view." << endl;
+            cout << "-a [spec] / -b [spec]: \t Engines, given as minimax:depth, alphabeta:depth, aspiration:depth or mcts:iterations." << endl;
+            cout << "\t\t\t Alpha-beta engines accept +lmr and +futility for a selective search, e.g. alphabeta:8+lmr+futility." << endl;
+            cout << "-n [num]: \t\t Number of games. A plays X in even games and O in odd games." << endl;
+            cout << "-t [num]: \t\t Number of worker threads. Defaults to the number of CPUs." << endl;
+            cout << "-o [num] or --openings [num]: \t Number of random opening moves played before the engines take over." << endl;
+            cout << "--seed [num]: \t\t Seed of the random openings." << endl;
+            cout << "--hash-mb [num]: \t Transposition table size of each engine in megabytes." << endl;
+            cout << "-r [num] or --radius [num]: \t Only let the engines search empty cells within num rows and columns of a stone." << endl;
+            cout << "--record [file]: \t Write all games to a binary record file, see pa3_replay.exe." << endl;
+            return 0;
+        }
+        string value = argv[++i];
+        if (option == "-a" || option == "-b") {
+            if (!parsePlayer(value, players[option == "-a" ? 0 : 1])) {
+                cout << "Unknown engine " << value << "." << endl;
+                return 0;
+            }
+        }
+        else if (option == "-n") games = atoi(value.c_str());
+        else if (option == "-t") threads = atoi(value.c_str());
+        else if (option == "-o" || option == "--openings") openingPlies = atoi(value.c_str());
+        else if (option == "--seed") seed = strtoull(value.c_str(), nullptr, 10);
+        else if (option == "--hash-mb") hashMB = atoi(value.c_str());
+        else if (option == "-r" || option == "--radius") players[0].limits.candidateRadius = players[1].limits.candidateRadius = atoi(value.c_str());
+        else if (option == "--record") recordPath = value;
+        else {
+            cout << "Invalid command line argument. Type pa3_selfplay.exe -h for details." << endl;
+            return 0;
+        }
+    }
+
+    vector<GameRecord> records(games > 0 ? games : 0);
+    chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+    {
+        WorkStealingPool pool{threads};
+        for (int g = 0; g < games; ++g) {
+            pool.submit([&, g]() {
+                // Engines are reused by all games played on the same worker, so the tables are only allocated once
+                static thread_local unique_ptr<Engine> engines[2];
+                for (int p = 0; p < 2; ++p) {
+                    if (!engines[p]) engines[p].reset(new Engine(hashMB));
+                    engines[p]->clear();
+                }
+
+                GameRecord& record = records[g];
+                Board board{SCORE_PRESET};
+                for (int i = 0; i < BOARD_SIZE; ++i) {
+                    for (int j = 0; j < BOARD_SIZE; ++j) {
+                        record.game.score[i][j] = SCORE_PRESET[i][j];
+                    }
+                }
+                unsigned long long rng = (seed + g) * 0x9E3779B97F4A7C15ULL | 1;
+                for (int ply = 0; ply < openingPlies && !board.isFinished(); ++ply) {
+                    BoardCoordinate coords{-1, -1};
+                    do {
+                        // Two statements, since the order in which arguments are evaluated is unspecified
+                        const int row = nextRandom(rng) % BOARD_SIZE;
+                        const int col = nextRandom(rng) % BOARD_SIZE;
+                        coords = BoardCoordinate(row, col);
+                    } while (!board.play(coords));
+                    RecordedMove opening;
+                    opening.cell = coords.row * BOARD_SIZE + coords.col;
+                    record.game.moves.push_back(opening);
+                }
+
+                // Player A is X in even games
+                const Cell playerACell = (g % 2 == 0) ? X : O;
+                while (!board.isFinished()) {
+                    const int p = (board.getCurPlayer() == playerACell) ? 0 : 1;
+                    SearchResult result = engines[p]->search(board, players[p].limits);
+                    record.nodes[p] += result.nodes;
+                    record.timeUs[p] += result.timeUs;
+                    record.moves[p]++;
+                    if (!board.play(result.move.coords)) break;
+
+                    RecordedMove move;
+                    move.cell = result.move.coords.row * BOARD_SIZE + result.move.coords.col;
+                    move.depth = (players[p].limits.algorithm == SearchLimits::MCTS) ? 0 : players[p].limits.depth;
+                    move.flags = RecordedMove::ENGINE | (result.provenWin ? RecordedMove::PROVEN : 0);
+                    move.algorithm = players[p].limits.algorithm;
+                    move.score = result.move.score;
+                    move.nodes = result.nodes;
+                    move.timeUs = result.timeUs;
+                    record.game.moves.push_back(move);
+                }
+
+                // Same rules as main_program.cpp: a match wins, otherwise the higher score wins on a full board
+                const int boardScore = board.getBoardScore();
+                const int winner = (boardScore > 0) - (boardScore < 0);
+                record.result = winner * playerACell;
+                record.game.result = boardScore;
+                record.game.finished = true;
+            });
+        }
+        pool.wait();
+    }
+    chrono::steady_clock::time_point end = chrono::steady_clock::now();
+
+    // Games are written in order once all of them have finished, so the file does not depend on the thread count
+    if (!recordPath.empty()) {
+        GameRecordWriter writer{recordPath};
+        if (!writer.isOpen()) {
+            cout << "Cannot open " << recordPath << " for writing." << endl;
+        }
+        for (const GameRecord& record : records) {
+            writer.writeGame(record.game);
+        }
+    }
+
+    int wins = 0, draws = 0, losses = 0;
+    unsigned long long nodes[2] = {0, 0};
+    long long timeUs[2] = {0, 0};
+    long long moves[2] = {0, 0};
+    for (const GameRecord& record : records) {
+        if (record.result > 0) ++wins;
+        else if (record.result < 0) ++losses;
+        else ++draws;
+        for (int p = 0; p < 2; ++p) {
+            nodes[p] += record.nodes[p];
+            timeUs[p] += record.timeUs[p];
+            moves[p] += record.moves[p];
+        }
+    }
+
+    cout << players[0].name << " vs " << players[1].name << ": " << games << " games, " << openingPlies << " random opening moves" << endl;
+    cout << "Win/draw/loss for " << players[0].name << ": " << wins << "/" << draws << "/" << losses << endl;
+    for (int p = 0; p < 2; ++p) {
+        cout << players[p].name << ": " << moves[p] << " moves, average "
+             << (moves[p] ? timeUs[p] / moves[p] : 0) << " us and "
+             << (moves[p] ? nodes[p] / moves[p] : 0) << " nodes per move" << endl;
+    }
+    cout << "Took " << chrono::duration_cast<chrono::milliseconds>(end - begin).count() << " milliseconds." << endl;
+    return 0;
+}
\ No newline at end of file
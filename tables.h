@@ -0,0 +1,114 @@
+#ifndef __TABLES_H__
+#define __TABLES_H__
+
+#include "const.h"
+
+// Lookup tables describing the board geometry. They are generated at compile time from BOARD_SIZE, so the evaluation
+// code only does table lookups instead of working out rows, columns and diagonals at runtime.
+// Cells are numbered row * BOARD_SIZE + col.
+
+const int CELL_COUNT = BOARD_SIZE * BOARD_SIZE;
+// Cells are stored in one byte by the transposition table and the game records, with 255 meaning "no cell"
+static_assert(CELL_COUNT < 255, "BOARD_SIZE is too large");
+static_assert(WIN_LENGTH >= 2 && WIN_LENGTH <= BOARD_SIZE, "WIN_LENGTH must be between 2 and BOARD_SIZE");
+
+// A match is WIN_LENGTH cells in a row, so every row, every column and every diagonal holds SEGMENTS overlapping lines
+const int SEGMENTS = BOARD_SIZE - WIN_LENGTH + 1;
+// The horizontal and vertical lines, followed by the diagonals in both directions
+const int LINE_COUNT = 2 * BOARD_SIZE * SEGMENTS + 2 * SEGMENTS * SEGMENTS;
+// A cell lies on at most WIN_LENGTH lines in each of the four directions
+const int MAX_CELL_LINES = 4 * WIN_LENGTH;
+
+// The cells of each line. With WIN_LENGTH == BOARD_SIZE, lines 0 to BOARD_SIZE - 1 are the rows, followed by the columns,
+// the main diagonal and the anti-diagonal. Otherwise each of them is split into its segments in the same order.
+struct LineTable {
+    int cells[LINE_COUNT][WIN_LENGTH];
+};
+
+constexpr LineTable makeLineTable()
+{
+    LineTable table {};
+    int line = 0;
+    for (int i = 0; i < BOARD_SIZE; ++i) {
+        for (int s = 0; s < SEGMENTS; ++s, ++line) {
+            for (int k = 0; k < WIN_LENGTH; ++k) {
+                table.cells[line][k] = i * BOARD_SIZE + s + k;
+            }
+        }
+    }
+    for (int i = 0; i < BOARD_SIZE; ++i) {
+        for (int s = 0; s < SEGMENTS; ++s, ++line) {
+            for (int k = 0; k < WIN_LENGTH; ++k) {
+                table.cells[line][k] = (s + k) * BOARD_SIZE + i;
+            }
+        }
+    }
+    for (int r = 0; r < SEGMENTS; ++r) {
+        for (int c = 0; c < SEGMENTS; ++c, ++line) {
+            for (int k = 0; k < WIN_LENGTH; ++k) {
+                table.cells[line][k] = (r + k) * BOARD_SIZE + (c + k);
+            }
+        }
+    }
+    for (int r = 0; r < SEGMENTS; ++r) {
+        for (int c = 0; c < SEGMENTS; ++c, ++line) {
+            for (int k = 0; k < WIN_LENGTH; ++k) {
+                table.cells[line][k] = (r + k) * BOARD_SIZE + (BOARD_SIZE - 1 - c - k);
+            }
+        }
+    }
+    return table;
+}
+
+constexpr LineTable WIN_LINES = makeLineTable();
+
+// The lines going through each cell, so that a move only has to look at the lines it can complete.
+struct CellLineTable {
+    int lines[CELL_COUNT][MAX_CELL_LINES];
+    int count[CELL_COUNT];
+};
+
+constexpr CellLineTable makeCellLineTable()
+{
+    CellLineTable table {};
+    for (int l = 0; l < LINE_COUNT; ++l) {
+        for (int k = 0; k < WIN_LENGTH; ++k) {
+            const int cell = WIN_LINES.cells[l][k];
+            table.lines[cell][table.count[cell]++] = l;
+        }
+    }
+    return table;
+}
+
+constexpr CellLineTable CELL_LINES = makeCellLineTable();
+
+// The board ID is the sum of the keys of the occupied cells. Up to 40 cells, the keys are 3 ^ cell for X and 2 * 3 ^ cell
+// for O, which makes the ID the exact base 3 encoding of the board. Larger boards do not fit in 64 bits that way, so they
+// use random (Zobrist) keys instead, and the ID becomes a hash.
+const bool EXACT_ID = CELL_COUNT <= 40;
+
+struct CellKeyTable {
+    unsigned long long value[CELL_COUNT][2]; // Key of X (index 0) and O (index 1) on each cell
+};
+
+constexpr CellKeyTable makeCellKeyTable()
+{
+    CellKeyTable table {};
+    unsigned long long power = 1;
+    unsigned long long state = 0x9E3779B97F4A7C15ULL;
+    for (int cell = 0; cell < CELL_COUNT; ++cell) {
+        for (int p = 0; p < 2; ++p) {
+            // SplitMix64
+            unsigned long long random = (state += 0x9E3779B97F4A7C15ULL);
+            random = (random ^ (random >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            random = (random ^ (random >> 27)) * 0x94D049BB133111EBULL;
+            table.value[cell][p] = EXACT_ID ? power * (p + 1) : random ^ (random >> 31);
+        }
+        power *= 3;
+    }
+    return table;
+}
+
+constexpr CellKeyTable CELL_KEYS = makeCellKeyTable();
+
+#endif // __TABLES_H__
\ No newline at end of file
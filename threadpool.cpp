@@ -0,0 +1,88 @@
+#include "threadpool.h"
+
+WorkStealingPool::WorkStealingPool(const unsigned int threadCount): queues(threadCount ? threadCount : 1)
+{
+    for (unsigned int t = 0; t < queues.size(); ++t) {
+        workers.push_back(std::thread(&WorkStealingPool::workerLoop, this, t));
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(waitMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+// void WorkStealingPool::submit(std::function<void()> task)
+//  The counters are updated before the task becomes visible, so wait() cannot miss it and queued never drops below 0.
+void WorkStealingPool::submit(std::function<void()> task)
+{
+    pending++;
+    {
+        std::lock_guard<std::mutex> lock(waitMutex);
+        queued++;
+    }
+    const unsigned int index = nextQueue++ % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(queues[index].mutex);
+        queues[index].tasks.push_back(std::move(task));
+    }
+    workAvailable.notify_one();
+}
+
+// bool WorkStealingPool::takeTask(const unsigned int index, std::function<void()>& task)
+//  Victims are tried in order starting after the worker's own queue, which spreads the thieves over the queues.
+bool WorkStealingPool::takeTask(const unsigned int index, std::function<void()>& task)
+{
+    for (unsigned int k = 0; k < queues.size(); ++k) {
+        WorkerQueue& queue = queues[(index + k) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        if (k == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        queued--;
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(const unsigned int index)
+{
+    while (true) {
+        std::function<void()> task;
+        if (takeTask(index, task)) {
+            task();
+            if (--pending == 0) {
+                std::lock_guard<std::mutex> lock(waitMutex);
+                allDone.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(waitMutex);
+        workAvailable.wait(lock, [this]() { return stopping || queued > 0; });
+        if (stopping && queued == 0) {
+            return;
+        }
+    }
+}
+
+void WorkStealingPool::wait()
+{
+    std::unique_lock<std::mutex> lock(waitMutex);
+    allDone.wait(lock, [this]() { return pending == 0; });
+}
\ No newline at end of file
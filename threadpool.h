@@ -0,0 +1,56 @@
+#ifndef __THREADPOOL_H__
+#define __THREADPOOL_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Thread pool with one task queue per worker. A worker takes new tasks from the back of its own queue and, when that is
+// empty, steals from the front of another worker's queue, so tasks of very different lengths (short and long games)
+// still keep every worker busy without a single contended queue.
+class WorkStealingPool {
+    private:
+        struct WorkerQueue {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        std::vector<WorkerQueue> queues;
+        std::vector<std::thread> workers;
+
+        std::mutex waitMutex;
+        std::condition_variable workAvailable;
+        std::condition_variable allDone;
+        std::atomic<unsigned long long> queued {0};  // Tasks submitted but not started yet
+        std::atomic<unsigned long long> pending {0}; // Tasks submitted but not finished yet
+        std::atomic<unsigned int> nextQueue {0};
+        bool stopping {false};
+
+        // Pop a task from the back of queue index, or steal one from the front of another queue
+        bool takeTask(const unsigned int index, std::function<void()>& task);
+
+        void workerLoop(const unsigned int index);
+
+    public:
+        // Start threadCount workers (at least 1)
+        WorkStealingPool(const unsigned int threadCount);
+        // Finish all submitted tasks, then stop the workers
+        ~WorkStealingPool();
+
+        WorkStealingPool(const WorkStealingPool&) = delete;
+        WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+        // Queue a task. Tasks are spread over the worker queues round-robin.
+        void submit(std::function<void()> task);
+
+        // Block until every submitted task has finished
+        void wait();
+
+        unsigned int getThreadCount() const { return static_cast<unsigned int>(workers.size()); }
+};
+
+#endif // __THREADPOOL_H__
\ No newline at end of file